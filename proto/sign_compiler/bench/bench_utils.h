@@ -0,0 +1,211 @@
+// bench/bench_utils.h
+/**
+ * Sign言語プリプロセッサのベンチマーク共通ユーティリティ
+ *
+ * 機能:
+ * - 高分解能タイマー
+ * - 入力ファイルの列挙と読み込み
+ * - 繰り返し計測と集計（中央値・最小値・中央絶対偏差）
+ * - JSON出力用の文字列変換
+ *
+ * ver_20261016_1
+ */
+#ifndef SIGN_BENCH_BENCH_UTILS_H
+#define SIGN_BENCH_BENCH_UTILS_H
+
+#include "common/utils/file_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sign
+{
+    namespace bench
+    {
+
+        // 経過時間を秒で返すタイマー
+        class Timer
+        {
+        public:
+            Timer() : start(std::chrono::steady_clock::now()) {}
+
+            double seconds() const
+            {
+                return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+
+        private:
+            std::chrono::steady_clock::time_point start;
+        };
+
+        // 入力ファイル（パスと内容）
+        struct InputFile
+        {
+            std::string path;
+            std::string content;
+        };
+
+        /**
+         * 引数で指定されたファイルまたはディレクトリ内の .sn ファイルを読み込む
+         * 処理済みファイル (*_processed.sn) は除外する
+         *
+         * @param paths ファイルまたはディレクトリのパス
+         * @return 読み込んだ入力ファイル
+         */
+        inline std::vector<InputFile> loadInputs(const std::vector<std::string> &paths)
+        {
+            namespace fs = std::filesystem;
+
+            std::vector<std::string> files;
+            for (const auto &path : paths)
+            {
+                if (fs::is_directory(path))
+                {
+                    for (const auto &entry : fs::directory_iterator(path))
+                    {
+                        const std::string name = entry.path().filename().string();
+                        if (entry.path().extension() == ".sn" && name.find("_processed") == std::string::npos)
+                        {
+                            files.push_back(entry.path().string());
+                        }
+                    }
+                }
+                else
+                {
+                    files.push_back(path);
+                }
+            }
+            std::sort(files.begin(), files.end());
+
+            std::vector<InputFile> inputs;
+            for (const auto &file : files)
+            {
+                inputs.push_back({file, common::readFromFile(file)});
+            }
+            return inputs;
+        }
+
+        // 繰り返し計測の中央値を返す
+        inline double median(std::vector<double> samples)
+        {
+            if (samples.empty())
+            {
+                return 0.0;
+            }
+            std::sort(samples.begin(), samples.end());
+            const size_t mid = samples.size() / 2;
+            return (samples.size() % 2) ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0;
+        }
+
+        // 繰り返し計測の要約（秒）
+        struct Summary
+        {
+            size_t count = 0;   // 計測回数
+            double median = 0.0; // 中央値
+            double min = 0.0;    // 最小値
+            double max = 0.0;    // 最大値
+            double mad = 0.0;    // 中央絶対偏差（外れ値に強いばらつきの指標）
+        };
+
+        inline Summary summarize(const std::vector<double> &samples)
+        {
+            Summary summary;
+            if (samples.empty())
+            {
+                return summary;
+            }
+            summary.count = samples.size();
+            summary.median = median(samples);
+            summary.min = *std::min_element(samples.begin(), samples.end());
+            summary.max = *std::max_element(samples.begin(), samples.end());
+
+            std::vector<double> deviations;
+            deviations.reserve(samples.size());
+            for (double sample : samples)
+            {
+                deviations.push_back(sample > summary.median ? sample - summary.median : summary.median - sample);
+            }
+            summary.mad = median(deviations);
+            return summary;
+        }
+
+        /**
+         * 処理を繰り返し計測する
+         * ウォームアップの後、最低回数に達し、かつ合計時間が最低時間を超えるまで繰り返す
+         *
+         * @param body 計測する処理
+         * @param warmup 計測しない事前実行の回数
+         * @param minReps 最低計測回数
+         * @param minSeconds 最低合計時間（秒）
+         * @param maxReps 最大計測回数
+         * @return 各回の処理時間（秒）
+         */
+        template <typename Body>
+        std::vector<double> measure(Body body, int warmup, int minReps, double minSeconds, int maxReps)
+        {
+            for (int i = 0; i < warmup; ++i)
+            {
+                body();
+            }
+
+            std::vector<double> samples;
+            double total = 0.0;
+            while (static_cast<int>(samples.size()) < maxReps &&
+                   (static_cast<int>(samples.size()) < minReps || total < minSeconds))
+            {
+                Timer timer;
+                body();
+                samples.push_back(timer.seconds());
+                total += samples.back();
+            }
+            return samples;
+        }
+
+        // JSON の文字列リテラルに変換する
+        inline std::string jsonString(std::string_view text)
+        {
+            std::string quoted = "\"";
+            for (char c : text)
+            {
+                switch (c)
+                {
+                case '"':
+                    quoted += "\\\"";
+                    break;
+                case '\\':
+                    quoted += "\\\\";
+                    break;
+                case '\n':
+                    quoted += "\\n";
+                    break;
+                case '\t':
+                    quoted += "\\t";
+                    break;
+                case '\r':
+                    quoted += "\\r";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        static const char hex[] = "0123456789abcdef";
+                        quoted += "\\u00";
+                        quoted += hex[(c >> 4) & 0xf];
+                        quoted += hex[c & 0xf];
+                    }
+                    else
+                    {
+                        quoted += c;
+                    }
+                }
+            }
+            quoted += '"';
+            return quoted;
+        }
+
+    } // namespace bench
+} // namespace sign
+
+#endif // SIGN_BENCH_BENCH_UTILS_H
@@ -0,0 +1,401 @@
+// bench/corpus_gen.cpp
+/**
+ * スケーリング・負荷試験用のSignコード生成ツール
+ *
+ * 機能:
+ * - 指定した規模の正しいSignコードを生成（同じシード値なら同じ出力）
+ * - 生成する特徴を個別に調整できる
+ *   ブロック数、定義数、ラムダ式のネストの深さと引数の数、部分適用の穴（_）の割合、
+ *   文字列リテラル、インデントによる辞書、定義の依存の連鎖
+ * - ブロックごとに出力先へ書き出す（生成結果全体を保持しない）
+ *
+ * 生成されるコードの構成:
+ * - ライブラリ部: 演算子の部分適用の定義（[+ 3] など）。依存の連鎖が指定された場合は
+ *   前の定義を参照する（f1 : [f0] [* 2]）
+ * - 本体部: 関数の適用（部分適用を含む）、ネストしたラムダ式、条件分岐、辞書、文字列の定義
+ *
+ * 使い方:
+ * corpus_gen [--blocks <数>] [--definitions <数>] [--depth <深さ>] [--arity <引数の数>]
+ *            [--holes <割合>] [--strings <割合>] [--dicts <割合>] [--dict-depth <深さ>]
+ *            [--chain <長さ>] [--seed <値>] [--output <ファイル>]
+ * (割合は 0～1、--output 省略時は標準出力)
+ *
+ * 例: corpus_gen --blocks 100000 --depth 8 --output big.sn && stage_bench big.sn
+ *
+ * ver_20261016_0
+ */
+
+#include "common/utils/output_sink.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace sign;
+
+    // 生成の設定
+    struct CorpusOptions
+    {
+        size_t blocks = 1000;      // 本体部のブロック数
+        size_t definitions = 100;  // ライブラリ部の定義数
+        size_t depth = 2;          // ラムダ式のネストの深さ
+        size_t arity = 2;          // ラムダ式1つあたりの引数の数
+        double holes = 0.3;        // 関数適用の引数を _ にする割合
+        double strings = 0.1;      // 文字列の定義のブロックの割合
+        double dicts = 0.05;       // 辞書のブロックの割合
+        size_t dictDepth = 2;      // 辞書の階層の深さ
+        size_t chain = 1;          // ライブラリ部の定義の依存の連鎖の長さ（1なら依存なし）
+        uint64_t seed = 1;         // 乱数のシード値
+        std::string output = "-"; // 出力ファイル
+    };
+
+    /**
+     * 決定的な乱数生成器（splitmix64）
+     * 標準ライブラリの分布は実装ごとに結果が異なるため、環境によらず同じコードを生成できるよう自前で実装する
+     */
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed) : state(seed) {}
+
+        uint64_t next()
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        // 0 以上 n 未満の整数
+        size_t below(size_t n) { return n == 0 ? 0 : static_cast<size_t>(next() % n); }
+
+        // 確率 p で true
+        bool chance(double p) { return static_cast<double>(next() >> 11) * 0x1.0p-53 < p; }
+
+    private:
+        uint64_t state;
+    };
+
+    const char *const ARITHMETIC[] = {"+", "-", "*", "/", "%"};
+    const char *const COMPARISON[] = {"<", "<=", "=", ">=", ">", "!="};
+    const char *const WORDS[] = {"alpha", "beta", "gamma", "delta", "sign", "list", "value", "text"};
+
+    template <typename T, size_t N>
+    const T &pick(Random &random, const T (&items)[N])
+    {
+        return items[random.below(N)];
+    }
+
+    class CorpusGenerator
+    {
+    public:
+        CorpusGenerator(const CorpusOptions &options, common::OutputSink &output)
+            : options(options), output(output), random(options.seed) {}
+
+        void generate()
+        {
+            for (size_t i = 0; i < options.definitions; ++i)
+            {
+                writeLibraryDefinition(i);
+            }
+
+            // 本体部で参照する関数（引数の数が options.arity のラムダ式）
+            writeLine("apply_fn : " + parameters("a", options.arity) + " ? " + joinParameters("a", options.arity, " + "));
+
+            for (size_t n = 0; n < options.blocks; ++n)
+            {
+                if (random.chance(options.dicts))
+                {
+                    writeDictionary(n);
+                }
+                else if (random.chance(options.strings))
+                {
+                    writeString(n);
+                }
+                else
+                {
+                    switch (random.below(3))
+                    {
+                    case 0:
+                        writeApplication(n);
+                        break;
+                    case 1:
+                        writeLambda(n);
+                        break;
+                    default:
+                        writeMatchCase(n);
+                        break;
+                    }
+                }
+            }
+            output.flush();
+        }
+
+    private:
+        void writeLine(const std::string &line)
+        {
+            output.write(line);
+            output.write("\n");
+        }
+
+        // ライブラリ部の定義を参照する（定義がなければ演算子の部分適用をそのまま使う）
+        std::string libraryReference()
+        {
+            if (options.definitions == 0)
+            {
+                return "[+ 1]";
+            }
+            return "f" + std::to_string(random.below(options.definitions));
+        }
+
+        // 連鎖の先頭は演算子の部分適用、それ以外は直前の定義を参照する
+        void writeLibraryDefinition(size_t i)
+        {
+            const std::string section = std::string("[") + pick(random, ARITHMETIC) + " " + std::to_string(1 + random.below(9)) + "]";
+            if (options.chain > 1 && i % options.chain != 0)
+            {
+                writeLine("f" + std::to_string(i) + " : [f" + std::to_string(i - 1) + "] " + section);
+            }
+            else
+            {
+                writeLine("f" + std::to_string(i) + " : " + section);
+            }
+        }
+
+        // 関数の適用（引数の一部を _ にして部分適用にする）
+        void writeApplication(size_t n)
+        {
+            std::string line = "v" + std::to_string(n) + " : apply_fn";
+            for (size_t k = 0; k < options.arity; ++k)
+            {
+                if (random.chance(options.holes))
+                {
+                    line += " _";
+                }
+                else if (random.chance(0.5))
+                {
+                    line += " " + std::to_string(random.below(1000));
+                }
+                else
+                {
+                    line += " [" + libraryReference() + " " + std::to_string(random.below(100)) + "]";
+                }
+            }
+            writeLine(line);
+        }
+
+        // ネストしたラムダ式（内側のラムダ式は外側の引数も参照する）
+        void writeLambda(size_t n)
+        {
+            const std::string prefix = "p" + std::to_string(n) + "_";
+            writeLine("h" + std::to_string(n) + " : " + lambda(prefix, 0, ""));
+        }
+
+        std::string lambda(const std::string &prefix, size_t level, const std::string &outer)
+        {
+            const std::string name = prefix + std::to_string(level) + "_";
+            std::string body = joinParameters(name, options.arity, std::string(" ") + pick(random, ARITHMETIC) + " ");
+            if (!outer.empty())
+            {
+                body += " * " + outer;
+            }
+            if (level + 1 < std::max<size_t>(options.depth, 1))
+            {
+                body += " + [" + lambda(prefix, level + 1, name + "0") + "] " + std::to_string(random.below(10));
+            }
+            else if (options.definitions > 0)
+            {
+                body += " + " + libraryReference() + " " + name + "0";
+            }
+            return parameters(name, options.arity) + " ? " + body;
+        }
+
+        // 条件分岐（タブで始まる行は同じブロック）
+        void writeMatchCase(size_t n)
+        {
+            writeLine("m" + std::to_string(n) + " : x ?");
+            const size_t cases = 1 + random.below(3);
+            for (size_t k = 0; k < cases; ++k)
+            {
+                writeLine(std::string("\tx ") + pick(random, COMPARISON) + " " + std::to_string(random.below(100)) +
+                          " : " + libraryReference() + " x");
+            }
+            writeLine("\t_");
+        }
+
+        // インデントによる辞書
+        void writeDictionary(size_t n)
+        {
+            writeLine("d" + std::to_string(n) + " :");
+            writeDictionaryLevel(1);
+        }
+
+        void writeDictionaryLevel(size_t level)
+        {
+            const std::string indent(level, '\t');
+            const size_t width = 1 + random.below(3);
+            for (size_t k = 0; k < width; ++k)
+            {
+                const std::string key = std::string(pick(random, WORDS)) + std::to_string(k);
+                if (level < options.dictDepth && random.chance(0.5))
+                {
+                    writeLine(indent + key + " :");
+                    writeDictionaryLevel(level + 1);
+                }
+                else if (random.chance(options.strings))
+                {
+                    writeLine(indent + key + " : " + stringLiteral());
+                }
+                else
+                {
+                    writeLine(indent + key + " : " + std::to_string(random.below(10000)));
+                }
+            }
+        }
+
+        // 文字列の定義
+        void writeString(size_t n)
+        {
+            writeLine("s" + std::to_string(n) + " : " + stringLiteral());
+        }
+
+        // 文字列リテラル（構文上の記号を含めて、リテラルの保護も試験する）
+        std::string stringLiteral()
+        {
+            static const char *const PIECES[] = {"text", "[x]", "a : b", "x ? y", "_ _", "(1 2)", "{k}", "~rest", "値"};
+            std::string literal = "`";
+            const size_t pieces = 1 + random.below(4);
+            for (size_t k = 0; k < pieces; ++k)
+            {
+                literal += (k > 0 ? " " : "");
+                literal += pick(random, PIECES);
+            }
+            return literal + "`";
+        }
+
+        // 引数の並び（a0 a1 ...）
+        std::string parameters(const std::string &name, size_t count)
+        {
+            return joinParameters(name, count, " ");
+        }
+
+        std::string joinParameters(const std::string &name, size_t count, const std::string &separator)
+        {
+            std::string result;
+            for (size_t k = 0; k < std::max<size_t>(count, 1); ++k)
+            {
+                result += (k > 0 ? separator : "") + name + std::to_string(k);
+            }
+            return result;
+        }
+
+        const CorpusOptions &options;
+        common::OutputSink &output;
+        Random random;
+    };
+
+    bool parseRatio(const char *text, double &value)
+    {
+        char *end = nullptr;
+        value = std::strtod(text, &end);
+        return end != text && *end == '\0' && value >= 0.0 && value <= 1.0;
+    }
+
+    bool parseCount(const char *text, size_t &value)
+    {
+        char *end = nullptr;
+        value = std::strtoull(text, &end, 10);
+        return end != text && *end == '\0';
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    CorpusOptions options;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--blocks") == 0 && hasValue)
+        {
+            valid = parseCount(argv[++i], options.blocks);
+        }
+        else if (std::strcmp(argv[i], "--definitions") == 0 && hasValue)
+        {
+            valid = parseCount(argv[++i], options.definitions);
+        }
+        else if (std::strcmp(argv[i], "--depth") == 0 && hasValue)
+        {
+            valid = parseCount(argv[++i], options.depth);
+        }
+        else if (std::strcmp(argv[i], "--arity") == 0 && hasValue)
+        {
+            valid = parseCount(argv[++i], options.arity);
+        }
+        else if (std::strcmp(argv[i], "--holes") == 0 && hasValue)
+        {
+            valid = parseRatio(argv[++i], options.holes);
+        }
+        else if (std::strcmp(argv[i], "--strings") == 0 && hasValue)
+        {
+            valid = parseRatio(argv[++i], options.strings);
+        }
+        else if (std::strcmp(argv[i], "--dicts") == 0 && hasValue)
+        {
+            valid = parseRatio(argv[++i], options.dicts);
+        }
+        else if (std::strcmp(argv[i], "--dict-depth") == 0 && hasValue)
+        {
+            valid = parseCount(argv[++i], options.dictDepth);
+        }
+        else if (std::strcmp(argv[i], "--chain") == 0 && hasValue)
+        {
+            valid = parseCount(argv[++i], options.chain);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            size_t seed = 0;
+            valid = parseCount(argv[++i], seed);
+            options.seed = seed;
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && hasValue)
+        {
+            options.output = argv[++i];
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+    if (!valid)
+    {
+        std::cerr << "使い方: corpus_gen [--blocks <数>] [--definitions <数>] [--depth <深さ>] [--arity <引数の数>]"
+                     " [--holes <割合>] [--strings <割合>] [--dicts <割合>] [--dict-depth <深さ>]"
+                     " [--chain <長さ>] [--seed <値>] [--output <ファイル>]"
+                  << std::endl;
+        return 1;
+    }
+
+    common::FileSink output(options.output);
+    if (!output.isOpen())
+    {
+        std::cerr << "出力ファイルを開けませんでした: " << options.output << std::endl;
+        return 1;
+    }
+    CorpusGenerator(options, output).generate();
+    if (!output.close())
+    {
+        std::cerr << "出力ファイルへの書き込みに失敗しました: " << options.output << std::endl;
+        return 1;
+    }
+    if (options.output != "-")
+    {
+        std::cerr << options.output << ": " << output.bytesWritten() << " bytes" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+// bench/definition_bench.cpp
+/**
+ * 定義の依存関係の解決のベンチマーク
+ *
+ * 機能:
+ * - 大量の定義（既定で100万件）を持つ3種類の依存グラフで resolveNestedDefinitions を計測
+ *   - ring:  d0 → d1 → ... → d(N-1) → d0 の1つの大きな循環（すべて循環参照）
+ *   - chain: d0 → d1 → ... → d(N-1) : 1 の長い連鎖（すべて 1 に展開される）
+ *   - fan:   多数の定義が少数の共有された定義を参照する
+ * - 各グラフの解決結果を検証（長い連鎖でもスタックを消費しないことの確認を兼ねる）
+ * - 循環する定義の展開結果を検証（展開しない定義を経由する循環は展開が止まるまで展開し、
+ *   展開する定義だけの循環は展開しない）
+ *
+ * 使い方:
+ * definition_bench [--count <定義数>]
+ *
+ * ver_20261016_1
+ */
+
+#include "bench/bench_utils.h"
+#include "common/lexer/tokenizer.h"
+#include "preprocessor/lambda_processor.h"
+#include "preprocessor/sign_transformer.h"
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    using namespace sign;
+
+    constexpr size_t FAN_BASES = 1000;
+
+    // 1行1定義のソースを生成し、各行をトークン化して定義を抽出する
+    // 定義トークンはソースへのビューなので、sourceは定義テーブルより長く生存する必要がある
+    DefinitionTable buildDefinitions(size_t count, std::string &source,
+                                     const std::function<std::string(size_t)> &body)
+    {
+        std::vector<size_t> lineStarts;
+        for (size_t i = 0; i < count; ++i)
+        {
+            lineStarts.push_back(source.size());
+            source += "d" + std::to_string(i) + " : " + body(i) + "\n";
+        }
+        lineStarts.push_back(source.size());
+
+        std::vector<std::vector<common::Token>> blocks(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            blocks[i] = common::tokenizeBlock(std::string_view(source).substr(lineStarts[i], lineStarts[i + 1] - lineStarts[i] - 1));
+        }
+        return extractDefinitions(blocks);
+    }
+
+    // 定義 d<i> の解決結果を空白区切りの文字列で返す
+    std::string resolvedText(const DefinitionTable &resolved, size_t i)
+    {
+        auto it = resolved.find(common::globalSymbols().find("d" + std::to_string(i)));
+        if (it == resolved.end())
+        {
+            return "(なし)";
+        }
+        std::string text;
+        common::appendTokens(text, it->second);
+        return text;
+    }
+
+    // 1種類のグラフを解決して計測・検証する
+    bool runShape(const char *label, size_t count,
+                  const std::function<std::string(size_t)> &body,
+                  const std::function<std::string(size_t)> &expected)
+    {
+        std::string source;
+        bench::Timer buildTimer;
+        const DefinitionTable definitions = buildDefinitions(count, source, body);
+        const double buildSeconds = buildTimer.seconds();
+
+        bench::Timer resolveTimer;
+        const DefinitionTable resolved = resolveNestedDefinitions(definitions);
+        const double resolveSeconds = resolveTimer.seconds();
+
+        std::cout << std::left << std::setw(6) << label << std::right
+                  << ": " << definitions.size() << " 定義, 解決 " << resolveSeconds * 1e3 << " ms ("
+                  << resolveSeconds * 1e9 / static_cast<double>(count) << " ns/定義, 構築 "
+                  << buildSeconds * 1e3 << " ms)" << std::endl;
+
+        // 先頭・中央・末尾の定義を検証
+        if (resolved.size() != count)
+        {
+            std::cerr << label << ": 定義数が一致しません" << std::endl;
+            return false;
+        }
+        for (size_t i : {size_t(0), count / 2, count - 1})
+        {
+            const std::string actual = resolvedText(resolved, i);
+            if (actual != expected(i))
+            {
+                std::cerr << label << ": d" << i << " の解決結果が一致しません\n  期待: " << expected(i)
+                          << "\n  結果: " << actual << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 循環する定義を含むソースの前処理結果を検証する
+    bool checkCircularCases()
+    {
+        static const std::pair<const char *, const char *> cases[] = {
+            // nop の定義 x は [ で始まらないので展開せず、そこで止まる
+            {"x : [nop] k\nnop : x\ny : x 1", "x : [ nop ] k\nnop : [ nop ] k\ny : [ nop ] k 1"},
+            {"x : [nop] k\nnop : x\nz : [x]\nw : z 3", "x : [ nop ] k\nnop : [ nop ] k\nz : [ [ nop ] k ]\nw : [ [ nop ] k ] 3"},
+            // 展開する定義だけの循環は展開しても終わらないので展開しない
+            {"p : [q]\nq : [p]\nr : p 2", "p : [ q ]\nq : [ p ]\nr : p 2"},
+            {"p : [q]\nq : [p]\ns : [p 1]\nt : s", "p : [ q ]\nq : [ p ]\ns : [ p 1 ]\nt : [ p 1 ]"},
+        };
+
+        bool ok = true;
+        for (const auto &[source, expected] : cases)
+        {
+            const std::string actual = preprocessSourceCode(source);
+            if (actual != expected)
+            {
+                std::cerr << "循環する定義の展開結果が一致しません:\n" << source << "\n  期待:\n" << expected << "\n  結果:\n" << actual << std::endl;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t count = 1000000;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+        {
+            count = std::max<size_t>(FAN_BASES * 2, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            std::cerr << "使い方: definition_bench [--count <定義数>]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!checkCircularCases())
+    {
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    const auto name = [](size_t i)
+    { return "d" + std::to_string(i); };
+
+    // ring: 循環に含まれる定義は展開せずにそのまま残る
+    const auto ringBody = [&](size_t i)
+    { return name((i + 1) % count) + " + 1"; };
+    bool ok = runShape("ring", count, ringBody, ringBody);
+
+    // chain: 深さ count の連鎖がすべて末尾のリテラルに展開される
+    ok = ok && runShape("chain", count, [&](size_t i)
+                        { return i + 1 < count ? name(i + 1) : std::string("1"); }, [](size_t)
+                        { return std::string("1"); });
+
+    // fan: 先頭の定義を多数の定義が共有して参照する
+    ok = ok && runShape("fan", count, [&](size_t i)
+                        { return i < FAN_BASES ? "[+ " + std::to_string(i) + "]" : name(i % FAN_BASES) + " 1"; }, [](size_t i)
+                        { return i < FAN_BASES ? "[ + " + std::to_string(i) + " ]"
+                                               : "[ + " + std::to_string(i % FAN_BASES) + " ] 1"; });
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// bench/incremental_bench.cpp
+/**
+ * 差分プリプロセスのベンチマーク
+ *
+ * 機能:
+ * - 入力ファイルに小さな編集を繰り返し加え、編集ごとの
+ *   IncrementalPreprocessor::update と preprocessSourceCode（全体の再処理）の時間を比較
+ * - 毎回の出力が全体の再処理と一致することを検証
+ * - rebuild で編集中に増えた識別子を破棄した後も、出力と以降の差分更新が一致することを検証
+ *
+ * 使い方:
+ * incremental_bench [--edits <回数>] <ファイル>
+ *
+ * ver_20261016_1
+ */
+
+#include "bench/bench_utils.h"
+#include "preprocessor/incremental_preprocessor.h"
+#include "preprocessor/sign_transformer.h"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    // 行頭の位置の一覧
+    std::vector<size_t> lineStarts(const std::string &text)
+    {
+        std::vector<size_t> starts = {0};
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '\n' && i + 1 < text.size())
+            {
+                starts.push_back(i + 1);
+            }
+        }
+        return starts;
+    }
+
+    // エディタでの1回の編集を模した変更を加える
+    // 偶数回目は新しい定義の行を挿入し、奇数回目は既存の行の末尾に項を追加する
+    void applyEdit(std::string &text, size_t edit, std::mt19937 &random)
+    {
+        const std::vector<size_t> starts = lineStarts(text);
+        const size_t line = starts[std::uniform_int_distribution<size_t>(0, starts.size() - 1)(random)];
+        if (edit % 2 == 0)
+        {
+            text.insert(line, "edit_" + std::to_string(edit) + " : [+ " + std::to_string(edit) + "]\n");
+        }
+        else
+        {
+            size_t end = text.find('\n', line);
+            if (end == std::string::npos)
+            {
+                end = text.size();
+            }
+            text.insert(end, " " + std::to_string(edit));
+        }
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    using namespace sign;
+
+    size_t edits = 50;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--edits") == 0 && i + 1 < argc)
+        {
+            edits = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() != 1)
+    {
+        std::cerr << "使い方: incremental_bench [--edits <回数>] <ファイル>" << std::endl;
+        return 1;
+    }
+
+    std::string source = common::readFromFile(paths[0]);
+    std::mt19937 random(12345);
+
+    IncrementalPreprocessor session;
+    bench::Timer initialTimer;
+    session.update(source);
+    const double initialSeconds = initialTimer.seconds();
+
+    std::vector<double> fullSamples;
+    std::vector<double> incrementalSamples;
+    size_t reprocessed = 0;
+    size_t reapplied = 0;
+    for (size_t edit = 0; edit < edits; ++edit)
+    {
+        applyEdit(source, edit, random);
+
+        bench::Timer incrementalTimer;
+        IncrementalUpdate update = session.update(source);
+        const std::string incremental = session.output();
+        incrementalSamples.push_back(incrementalTimer.seconds());
+        reprocessed += update.reprocessedBlocks;
+        reapplied += update.reappliedBlocks;
+
+        bench::Timer fullTimer;
+        const std::string full = preprocessSourceCode(source);
+        fullSamples.push_back(fullTimer.seconds());
+
+        if (incremental != full)
+        {
+            std::cerr << "編集 " << edit << " の後に全体の再処理と出力が一致しません" << std::endl;
+            return 1;
+        }
+    }
+
+    // 入力途中の名前のように、一時的に現れて消える識別子を登録させる
+    for (size_t k = 0; k < edits; ++k)
+    {
+        session.update(source + "\ntyping_" + std::to_string(k) + " : " + std::to_string(k) + "\n");
+    }
+
+    // 編集で増えた識別子を破棄して処理し直し、その後の編集も差分更新できることを確認する
+    const size_t symbolsBeforeRebuild = common::globalSymbols().size();
+    session.rebuild(source);
+    const size_t symbolsAfterRebuild = common::globalSymbols().size();
+    if (session.output() != preprocessSourceCode(source))
+    {
+        std::cerr << "rebuild の後に全体の再処理と出力が一致しません" << std::endl;
+        return 1;
+    }
+    applyEdit(source, edits, random);
+    session.update(source);
+    if (session.output() != preprocessSourceCode(source))
+    {
+        std::cerr << "rebuild 後の編集で全体の再処理と出力が一致しません" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "入力: " << paths[0] << " (" << source.size() << " bytes, " << session.blockCount() << " ブロック)" << std::endl;
+    std::cout << "初回の処理: " << initialSeconds * 1e3 << " ms" << std::endl;
+    std::cout << "編集ごとの全体の再処理: " << bench::median(fullSamples) * 1e3 << " ms（中央値）" << std::endl;
+    std::cout << "編集ごとの差分更新:     " << bench::median(incrementalSamples) * 1e3 << " ms（中央値）" << std::endl;
+    std::cout << "編集あたりの再処理ブロック: " << double(reprocessed) / edits
+              << ", 定義の再適用ブロック: " << double(reapplied) / edits << std::endl;
+    std::cout << "rebuild による識別子の登録数: " << symbolsBeforeRebuild << " -> " << symbolsAfterRebuild << std::endl;
+    return 0;
+}
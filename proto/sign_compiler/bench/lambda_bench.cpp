@@ -0,0 +1,187 @@
+// bench/lambda_bench.cpp
+/**
+ * ラムダ式の引数置換のベンチマーク
+ *
+ * 機能:
+ * - ネストしたラムダ式の置換結果（シャドーイング、カリー化、引数位置の継続、本体の終わり）を検証
+ * - 深くネストしたカリー化定義（既定で64段）を並べたブロックの処理時間を計測
+ * - ネストの深さを変えてもトークンあたりの処理時間がほぼ一定であることを確認
+ *
+ * 使い方:
+ * lambda_bench [--depth <ネストの深さ>] [--tokens <トークン数>] [--reps <回数>] [--max-ratio <倍率>]
+ *
+ * ver_20261016_1
+ */
+
+#include "bench/bench_utils.h"
+#include "common/lexer/tokenizer.h"
+#include "preprocessor/lambda_processor.h"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    using namespace sign;
+
+    // ラムダ式の置換結果を空白区切りの文字列で返す
+    std::string renameLambdas(std::string_view source)
+    {
+        std::string output;
+        common::appendTokens(output, processLambdaExpressions(common::tokenizeBlock(source)));
+        return output;
+    }
+
+    // 置換結果の検証（入力と期待する結果）
+    bool checkCases()
+    {
+        static const std::pair<const char *, const char *> cases[] = {
+            {"add : x y ? x + y", "add : _0 _1 ? _0 + _1"},
+            {"R : _ ~x ? x", "R : _0 ~_1 ? _1"},
+            {"curry : a ? b ? c ? a b c", "curry : _0 ? _1 ? _2 ? _0 _1 _2"},
+            {"nested : x ? [y ? [z ? x + y + z]]", "nested : _0 ? [ _1 ? [ _2 ? _0 + _1 + _2 ] ]"},
+            {"shadow : x ? [x ? x + 1] x", "shadow : _0 ? [ _1 ? _1 + 1 ] _0"},
+            {"dup : x x ? x", "dup : _0 _1 ? _1"},
+            {"siblings : [p ? p] [q ? q] p", "siblings : [ _0 ? _0 ] [ _0 ? _0 ] p"},
+            {"free : x ? y x", "free : _0 ? y _0"},
+            {"dd :\n\ta : x ? x\n\tb : y ? y", "dd : \n\t a : _0 ? _0 \n\t b : _0 ? _0"},
+            {"abs : x ?\n\tx >= 0 : x\n\tx < 0 : x", "abs : _0 ? \n\t _0 >= 0 : _0 \n\t _0 < 0 : _0"},
+            {"entries : [a : x ? x, b : y ? x y]", "entries : [ a : _0 ? _0 , b : _0 ? x _0 ]"},
+            {"pair : k v ? ~k : v", "pair : _0 _1 ? ~_0 : _1"},
+        };
+
+        bool ok = true;
+        for (const auto &[source, expected] : cases)
+        {
+            const std::string actual = renameLambdas(source);
+            if (actual != expected)
+            {
+                std::cerr << "置換結果が一致しません: " << source << "\n  期待: " << expected << "\n  結果: " << actual << std::endl;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    // 深さ depth のカリー化定義を並べたブロックと、その期待する置換結果
+    struct NestedBlock
+    {
+        std::string source;
+        std::string expected;
+        size_t tokens = 0;
+    };
+
+    NestedBlock generateNestedBlock(size_t depth, size_t targetTokens)
+    {
+        NestedBlock block;
+        for (size_t line = 0; block.tokens < targetTokens || line == 0; ++line)
+        {
+            // cN : [a0 ? [a1 ? ... [aD ? a0 + a1 + ... + aD] ... ]]
+            std::string source = "c" + std::to_string(line) + " : ";
+            std::string expected = source;
+            for (size_t d = 0; d < depth; ++d)
+            {
+                source += "[a" + std::to_string(d) + " ? ";
+                expected += "[ _" + std::to_string(d) + " ? ";
+            }
+            for (size_t d = 0; d < depth; ++d)
+            {
+                source += (d > 0 ? " + a" : "a") + std::to_string(d);
+                expected += (d > 0 ? " + _" : "_") + std::to_string(d);
+            }
+            source += std::string(depth, ']');
+            for (size_t d = 0; d < depth; ++d)
+            {
+                expected += " ]";
+            }
+
+            block.source += (line > 0 ? "\n\t" : "") + source;
+            block.expected += (line > 0 ? " \n\t " : "") + expected;
+            block.tokens += 3 + 5 * depth;
+        }
+        return block;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t depth = 64;
+    size_t targetTokens = 200000;
+    int reps = 5;
+    double maxRatio = 3.0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+        {
+            depth = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--tokens") == 0 && i + 1 < argc)
+        {
+            targetTokens = std::max<size_t>(100, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--max-ratio") == 0 && i + 1 < argc)
+        {
+            maxRatio = std::atof(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "使い方: lambda_bench [--depth <ネストの深さ>] [--tokens <トークン数>] [--reps <回数>] [--max-ratio <倍率>]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!checkCases())
+    {
+        return 1;
+    }
+
+    // 浅いネストと指定した深さのネストで、トークンあたりの処理時間を比較する
+    double nsPerToken[2] = {0.0, 0.0};
+    const size_t depths[2] = {std::min<size_t>(4, depth), depth};
+    std::cout << std::fixed << std::setprecision(2);
+    for (int k = 0; k < 2; ++k)
+    {
+        const NestedBlock block = generateNestedBlock(depths[k], targetTokens);
+        const std::vector<common::Token> tokens = common::tokenizeBlock(block.source);
+
+        std::string output;
+        common::appendTokens(output, processLambdaExpressions(tokens));
+        if (output != block.expected)
+        {
+            std::cerr << "深さ " << depths[k] << " の置換結果が一致しません" << std::endl;
+            return 1;
+        }
+
+        std::vector<double> samples;
+        size_t sink = 0;
+        for (int r = 0; r < reps; ++r)
+        {
+            bench::Timer timer;
+            sink += processLambdaExpressions(tokens).size();
+            samples.push_back(timer.seconds());
+        }
+        const double best = *std::min_element(samples.begin(), samples.end());
+        nsPerToken[k] = best * 1e9 / static_cast<double>(tokens.size());
+        std::cout << "深さ " << std::setw(4) << depths[k] << ": " << tokens.size() << " トークン, "
+                  << best * 1e3 << " ms (" << nsPerToken[k] << " ns/トークン)" << std::endl;
+        if (sink == 0)
+        {
+            return 1;
+        }
+    }
+
+    // 1パスの置換なので、ネストの深さによらずトークンあたりの時間はほぼ一定のはず
+    const double ratio = nsPerToken[0] > 0.0 ? nsPerToken[1] / nsPerToken[0] : 0.0;
+    std::cout << "トークンあたりの時間の比: " << ratio << " (上限 " << maxRatio << ")" << std::endl;
+    if (ratio > maxRatio)
+    {
+        std::cerr << "ネストの深さに比例して遅くなっています" << std::endl;
+        return 1;
+    }
+    return 0;
+}
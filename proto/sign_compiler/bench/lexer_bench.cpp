@@ -0,0 +1,263 @@
+// bench/lexer_bench.cpp
+/**
+ * 字句解析のベンチマーク
+ *
+ * 機能:
+ * - 文字種別テーブルによる tokenizeBlock と、ハッシュ集合で判定する
+ *   従来方式のトークン化のスループット（トークン/秒）を比較
+ * - 両方式のトークン列が一致することを検証
+ *
+ * 使い方:
+ * lexer_bench [--reps <回数>] [<ファイルまたはディレクトリ>...]
+ * (省略時は example ディレクトリ)
+ *
+ * ver_20261016_1
+ */
+
+#include "bench/bench_utils.h"
+#include "common/lexer/tokenizer.h"
+#include "common/parser/block_extractor.h"
+#include "preprocessor/preprocessor.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+namespace legacy
+{
+    using sign::common::TokenType;
+
+    // 従来方式のトークン（値を所有する）
+    struct Token
+    {
+        std::string value;
+        TokenType type;
+    };
+
+    const std::unordered_set<std::string> INFIX_OPERATORS = {
+        ":", "?", " ", ",", "~", ";", "|", "&", "<", "<=", "=", ">=", ">", "!=",
+        "+", "-", "*", "/", "%", "^", "'", "@"};
+
+    const std::unordered_set<std::string> PREFIX_OPERATORS = {
+        "#", "~", "!", "$", "@", "[", "{", "("};
+
+    const std::unordered_set<std::string> POSTFIX_OPERATORS = {
+        "~", "!", "]", "}", ")"};
+
+    const std::unordered_set<char> BRACKETS = {
+        '[', ']', '(', ')', '{', '}'};
+
+    // 従来方式のトークン種類判定（ハッシュ集合による検索）
+    TokenType determineTokenType(const std::string &token)
+    {
+        if (token.empty())
+            return TokenType::UNKNOWN;
+        if (token == "?")
+            return TokenType::LAMBDA;
+        if (token == ":")
+            return TokenType::DEFINE;
+        if (token == ",")
+            return TokenType::COMMA;
+        if (BRACKETS.count(token[0]))
+            return (token[0] == '[' || token[0] == '(' || token[0] == '{') ? TokenType::BRACKET_OPEN : TokenType::BRACKET_CLOSE;
+        if (INFIX_OPERATORS.count(token) || PREFIX_OPERATORS.count(token) || POSTFIX_OPERATORS.count(token))
+            return TokenType::OPERATOR;
+        if (token[0] == '`')
+            return TokenType::STRING;
+        if (token[0] == '\\')
+            return TokenType::CHAR;
+        if (std::isdigit(static_cast<unsigned char>(token[0])) ||
+            (token[0] == '-' && token.size() > 1 && std::isdigit(static_cast<unsigned char>(token[1]))))
+            return TokenType::NUMBER;
+        if (token.find('\n') != std::string::npos)
+            return TokenType::NEWLINE;
+        if (token.find('\t') != std::string::npos)
+            return TokenType::INDENTATION;
+        if (std::isspace(static_cast<unsigned char>(token[0])))
+            return TokenType::WHITESPACE;
+        return TokenType::IDENTIFIER;
+    }
+
+    // 従来方式のトークン化（1文字ずつ文字列に追加し、確定時に種類を判定）
+    std::vector<Token> tokenizeBlock(const std::string &block)
+    {
+        std::vector<Token> tokens;
+        std::string currentToken;
+        bool inString = false;
+        bool inCharLiteral = false;
+        bool inIndent = false;
+
+        auto addCurrentToken = [&]()
+        {
+            if (!currentToken.empty())
+            {
+                tokens.push_back({currentToken, determineTokenType(currentToken)});
+                currentToken.clear();
+            }
+        };
+
+        for (size_t i = 0; i < block.size(); ++i)
+        {
+            char c = block[i];
+            if (inString)
+            {
+                currentToken += c;
+                if (c == '`')
+                {
+                    addCurrentToken();
+                    inString = false;
+                }
+                continue;
+            }
+            if (inCharLiteral)
+            {
+                currentToken += c;
+                addCurrentToken();
+                inCharLiteral = false;
+                continue;
+            }
+            if (inIndent)
+            {
+                if (c == '\t')
+                {
+                    currentToken += c;
+                }
+                else
+                {
+                    addCurrentToken();
+                    inIndent = false;
+                    --i;
+                }
+                continue;
+            }
+
+            if (c == '`')
+            {
+                addCurrentToken();
+                currentToken = c;
+                inString = true;
+            }
+            else if (c == '\\')
+            {
+                addCurrentToken();
+                currentToken = c;
+                inCharLiteral = true;
+            }
+            else if (c == '\n')
+            {
+                addCurrentToken();
+                currentToken = c;
+                inIndent = true;
+            }
+            else if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                addCurrentToken();
+            }
+            else if (BRACKETS.count(c) || c == ':' || c == '?' || c == ',')
+            {
+                addCurrentToken();
+                tokens.push_back({std::string(1, c), determineTokenType(std::string(1, c))});
+            }
+            else
+            {
+                currentToken += c;
+            }
+        }
+        addCurrentToken();
+        return tokens;
+    }
+} // namespace legacy
+
+int main(int argc, char *argv[])
+{
+    using namespace sign;
+
+    int reps = 20;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty())
+    {
+        paths.push_back("example");
+    }
+
+    // 入力を正規化してブロックに分割（トークン化の対象のみを計測する）
+    std::vector<std::string> blocks;
+    size_t totalBytes = 0;
+    for (const auto &input : bench::loadInputs(paths))
+    {
+        for (auto &block : common::extractCodeBlocks(normalizeSourceCode(input.content)))
+        {
+            totalBytes += block.size();
+            blocks.push_back(std::move(block));
+        }
+    }
+    if (blocks.empty())
+    {
+        std::cerr << "入力がありません" << std::endl;
+        return 1;
+    }
+
+    // 両方式のトークン列が一致することを検証
+    size_t totalTokens = 0;
+    for (const auto &block : blocks)
+    {
+        auto current = common::tokenizeBlock(block);
+        auto reference = legacy::tokenizeBlock(block);
+        if (current.size() != reference.size())
+        {
+            std::cerr << "トークン数が一致しません: " << block << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            if (current[i].value() != reference[i].value || current[i].type() != reference[i].type)
+            {
+                std::cerr << "トークンが一致しません: " << reference[i].value << std::endl;
+                return 1;
+            }
+        }
+        totalTokens += current.size();
+    }
+
+    // 各方式を繰り返し計測
+    std::vector<double> currentSamples;
+    std::vector<double> legacySamples;
+    size_t sink = 0;
+    for (int r = 0; r < reps; ++r)
+    {
+        bench::Timer legacyTimer;
+        for (const auto &block : blocks)
+        {
+            sink += legacy::tokenizeBlock(block).size();
+        }
+        legacySamples.push_back(legacyTimer.seconds());
+
+        bench::Timer currentTimer;
+        for (const auto &block : blocks)
+        {
+            sink += common::tokenizeBlock(block).size();
+        }
+        currentSamples.push_back(currentTimer.seconds());
+    }
+
+    const double legacyTime = bench::median(legacySamples);
+    const double currentTime = bench::median(currentSamples);
+    std::cout << "ブロック数: " << blocks.size() << ", バイト数: " << totalBytes
+              << ", トークン数: " << totalTokens << " (x" << reps << "回, 中央値)" << std::endl;
+    std::cout << "従来方式 (ハッシュ集合):  " << totalTokens / legacyTime << " トークン/秒" << std::endl;
+    std::cout << "テーブル方式 (constexpr): " << totalTokens / currentTime << " トークン/秒" << std::endl;
+    std::cout << "速度比: " << legacyTime / currentTime << "x" << std::endl;
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,241 @@
+// bench/rewrite_bench.cpp
+/**
+ * トークン列の書き換え処理のベンチマーク
+ *
+ * 機能:
+ * - 部分適用を大量に含む長いブロック（既定で約10万トークン）に対する
+ *   processPartialApplications と applyDefinitions の処理時間を計測
+ * - トークン列の途中で erase/insert する従来方式と比較し、結果が一致することを検証
+ *
+ * 使い方:
+ * rewrite_bench [--tokens <トークン数>] [--reps <回数>]
+ *
+ * ver_20261016_1
+ */
+
+#include "bench/bench_utils.h"
+#include "common/lexer/tokenizer.h"
+#include "preprocessor/lambda_processor.h"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace legacy
+{
+    using namespace sign::common;
+
+    // 従来方式の部分適用の変換（変換のたびに定義の右側を erase/insert する）
+    std::vector<Token> processPartialApplications(const std::vector<Token> &tokens)
+    {
+        std::vector<Token> result = tokens;
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            if (result[i].type() != TokenType::DEFINE || i == 0 || result[i - 1].type() != TokenType::IDENTIFIER)
+            {
+                continue;
+            }
+
+            bool hasLambdaOperator = false;
+            std::vector<size_t> unitPositions;
+            size_t defineStart = i + 1;
+            size_t defineEnd = result.size();
+            bool isSingleUnit = defineStart < result.size() &&
+                                result[defineStart].type() == TokenType::IDENTIFIER && result[defineStart].value() == "_" &&
+                                (defineStart + 1 == result.size() ||
+                                 result[defineStart + 1].type() == TokenType::DEFINE ||
+                                 result[defineStart + 1].type() == TokenType::BRACKET_CLOSE);
+
+            int nestedLevel = 0;
+            for (size_t j = defineStart; j < result.size(); ++j)
+            {
+                if (result[j].type() == TokenType::BRACKET_OPEN)
+                {
+                    nestedLevel++;
+                }
+                else if (result[j].type() == TokenType::BRACKET_CLOSE && --nestedLevel < 0)
+                {
+                    defineEnd = j;
+                    break;
+                }
+                if (result[j].type() == TokenType::DEFINE && nestedLevel == 0)
+                {
+                    defineEnd = j;
+                    break;
+                }
+                hasLambdaOperator = hasLambdaOperator || result[j].type() == TokenType::LAMBDA;
+                if (result[j].type() == TokenType::IDENTIFIER && result[j].value() == "_")
+                {
+                    unitPositions.push_back(j);
+                }
+            }
+
+            if (unitPositions.empty() || hasLambdaOperator || isSingleUnit)
+            {
+                continue;
+            }
+
+            std::vector<Token> newTokens;
+            for (size_t k = 0; k < unitPositions.size(); ++k)
+            {
+                newTokens.push_back(identifierToken(globalSymbols().intern("_" + std::to_string(k))));
+            }
+            newTokens.push_back(Token("?", TokenType::LAMBDA));
+            size_t unitIndex = 0;
+            for (size_t j = defineStart; j < defineEnd; ++j)
+            {
+                if (unitIndex < unitPositions.size() && j == unitPositions[unitIndex])
+                {
+                    newTokens.push_back(identifierToken(globalSymbols().intern("_" + std::to_string(unitIndex++))));
+                }
+                else
+                {
+                    newTokens.push_back(result[j]);
+                }
+            }
+
+            result.erase(result.begin() + defineStart, result.begin() + defineEnd);
+            result.insert(result.begin() + defineStart, newTokens.begin(), newTokens.end());
+            i = defineStart + newTokens.size() - 1;
+        }
+        return result;
+    }
+
+    // 従来方式の定義の適用（インライン展開のたびに erase/insert する）
+    std::vector<Token> applyDefinitions(const std::vector<Token> &tokens, const sign::ResolvedDefinitions &definitions)
+    {
+        std::vector<Token> result = tokens;
+        bool modified = true;
+        int iterationLimit = 10;
+        while (modified && iterationLimit-- > 0)
+        {
+            modified = false;
+            for (size_t i = 0; i < result.size(); ++i)
+            {
+                if (result[i].type() != TokenType::IDENTIFIER ||
+                    (i + 1 < result.size() && result[i + 1].type() == TokenType::DEFINE) ||
+                    result[i].prefixLength() > 0 || result[i].postfixLength() > 0)
+                {
+                    continue;
+                }
+                const sign::ResolvedDefinition *definition = definitions.find(result[i].symbol);
+                if (definition == nullptr || !definition->inlinable)
+                {
+                    continue;
+                }
+                result.erase(result.begin() + i);
+                result.insert(result.begin() + i, definition->tokens.begin(), definition->tokens.end());
+                i += definition->tokens.size() - 1;
+                modified = true;
+            }
+        }
+        return sign::processSpecialIdentifiers(result);
+    }
+} // namespace legacy
+
+namespace
+{
+    // 部分適用の定義と、インライン展開される識別子を並べた1つの長いブロックを生成する
+    std::string generateBlock(size_t targetTokens)
+    {
+        std::string block = "main : 0";
+        size_t tokens = 3;
+        for (size_t i = 0; tokens < targetTokens; ++i)
+        {
+            const std::string n = std::to_string(i);
+            block += "\n\tp" + n + " : add _ " + n + " _ inc double";
+            tokens += 9;
+        }
+        return block;
+    }
+
+    bool sameTokens(const std::vector<sign::common::Token> &a, const std::vector<sign::common::Token> &b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].type() != b[i].type() || a[i].value() != b[i].value())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    using namespace sign;
+
+    size_t targetTokens = 100000;
+    int reps = 3;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--tokens") == 0 && i + 1 < argc)
+        {
+            targetTokens = std::max<size_t>(100, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            std::cerr << "使い方: rewrite_bench [--tokens <トークン数>] [--reps <回数>]" << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string block = generateBlock(targetTokens);
+    const std::vector<common::Token> tokens = common::tokenizeBlock(block);
+    const std::vector<common::Token> partial = processPartialApplications(tokens);
+    // 長いブロック内の定義は互いに連鎖して解決が重くなるため、展開する定義は別ブロックから取る
+    const std::vector<std::vector<common::Token>> blocks = {
+        common::tokenizeBlock(std::string_view("inc : [+ 1]")),
+        common::tokenizeBlock(std::string_view("double : [* 2]"))};
+    const auto definitions = resolveDefinitions(extractDefinitions(blocks));
+
+    // 両方式の結果が一致することを検証
+    if (!sameTokens(partial, legacy::processPartialApplications(tokens)) ||
+        !sameTokens(applyDefinitions(partial, *definitions), legacy::applyDefinitions(partial, *definitions)))
+    {
+        std::cerr << "従来方式と結果が一致しません" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> samples[4];
+    size_t sink = 0;
+    for (int r = 0; r < reps; ++r)
+    {
+        bench::Timer t0;
+        sink += processPartialApplications(tokens).size();
+        samples[0].push_back(t0.seconds());
+
+        bench::Timer t2;
+        sink += applyDefinitions(partial, *definitions).size();
+        samples[2].push_back(t2.seconds());
+
+        // 従来方式はブロック長の2乗に比例して遅いため1回だけ計測する
+        if (r == 0)
+        {
+            bench::Timer t1;
+            sink += legacy::processPartialApplications(tokens).size();
+            samples[1].push_back(t1.seconds());
+
+            bench::Timer t3;
+            sink += legacy::applyDefinitions(partial, *definitions).size();
+            samples[3].push_back(t3.seconds());
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "ブロック: " << tokens.size() << " トークン（部分適用後 " << partial.size() << "）" << std::endl;
+    std::cout << "部分適用の変換: " << bench::median(samples[0]) * 1e3 << " ms（従来方式 "
+              << bench::median(samples[1]) * 1e3 << " ms）" << std::endl;
+    std::cout << "定義の適用:     " << bench::median(samples[2]) * 1e3 << " ms（従来方式 "
+              << bench::median(samples[3]) * 1e3 << " ms）" << std::endl;
+    return sink == 0 ? 1 : 0;
+}
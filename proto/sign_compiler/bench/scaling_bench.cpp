@@ -0,0 +1,195 @@
+// bench/scaling_bench.cpp
+/**
+ * 前処理段階の計算量を検査するスケーリングベンチマーク
+ *
+ * 機能:
+ * - 各ケースで入力サイズ N と 2N の処理時間を計測し、
+ *   時間の比が許容値を超えたら（線形でなければ）失敗として終了コード1を返す
+ * - 1パス正規化の結果が段階的な処理
+ *   （removeComments → unifyBrackets → extractCodeBlocks）と一致することを検証
+ *
+ * 使い方:
+ * scaling_bench [--size <バイト数>] [--reps <回数>] [--max-ratio <比>]
+ *
+ * ver_20261016_0
+ */
+
+#include "bench/bench_utils.h"
+#include "common/parser/block_extractor.h"
+#include "common/parser/source_normalizer.h"
+#include "common/utils/string_utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    using namespace sign;
+
+    // 計測ケース（指定サイズの入力を生成する関数と、計測対象の処理）
+    struct ScalingCase
+    {
+        const char *name;
+        std::function<std::string(size_t)> generate;
+        std::function<size_t(const std::string &)> run;
+    };
+
+    // 断片を繰り返して指定サイズ以上の入力を生成する
+    std::string repeatUntil(const std::string &fragment, size_t size)
+    {
+        std::string text;
+        text.reserve(size + fragment.size());
+        while (text.size() < size)
+        {
+            text += fragment;
+        }
+        return text;
+    }
+
+    size_t runNormalizer(const std::string &source)
+    {
+        return common::normalizeSource(source).blocks.size();
+    }
+
+    // 1パス正規化と段階的な処理の結果が一致するか検証する
+    bool matchesStagedNormalization(const std::string &source)
+    {
+        const common::NormalizedSource fused = common::normalizeSource(source);
+        const std::string staged = common::unifyBrackets(common::removeComments(source));
+        if (fused.code != staged)
+        {
+            return false;
+        }
+
+        const std::vector<std::string> blocks = common::extractCodeBlocks(staged);
+        if (blocks.size() != fused.blocks.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            if (fused.code.compare(fused.blocks[i].offset, fused.blocks[i].length, blocks[i]) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<ScalingCase> buildCases()
+    {
+        return {
+            {"normalize/mixed",
+             [](size_t size)
+             {
+                 return repeatUntil("` comment line (a) {b}\n"
+                                    "add : x y ? x + y\n"
+                                    "map : f (x ~) ? [f x] , (map f ~x)\n"
+                                    "\tcase1 {x} : `str (not) bracket`\n"
+                                    "   \t \n"
+                                    "\\( \\} [1 2 3]\t \n",
+                                    size);
+             },
+             runNormalizer},
+            {"normalize/literals",
+             [](size_t size)
+             {
+                 // 文字列リテラルが多い入力（リテラル数に対して線形であること）
+                 return repeatUntil("s : `(a)` (b) `{c}` {d}\n", size);
+             },
+             runNormalizer},
+            {"normalize/comments",
+             [](size_t size)
+             {
+                 return repeatUntil("` (comment) `unclosed\n\t` indented comment\nx : (1)\n", size);
+             },
+             runNormalizer},
+            {"normalize/long-block",
+             [](size_t size)
+             {
+                 // 1つの巨大なブロック（継続行のみ）
+                 return "block :\n" + repeatUntil("\t(a b) {c} `d (e)`\n", size);
+             },
+             runNormalizer},
+            {"normalize/unclosed-literal",
+             [](size_t size)
+             {
+                 // 閉じていないバッククォートの後のカッコは変換される
+                 return "x : `open\n" + repeatUntil("(a) {b} c\n", size);
+             },
+             runNormalizer},
+        };
+    }
+
+    // 指定サイズで繰り返し計測した最小値（秒、比較のため雑音の少ない最小値を使う）
+    // 処理結果は sink に加算して最適化で消されないようにする
+    double measure(const ScalingCase &c, const std::string &input, int reps, size_t &sink)
+    {
+        std::vector<double> samples;
+        for (int r = 0; r < reps; ++r)
+        {
+            bench::Timer timer;
+            sink += c.run(input);
+            samples.push_back(timer.seconds());
+        }
+        return *std::min_element(samples.begin(), samples.end());
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t size = 1 << 20;
+    int reps = 7;
+    double maxRatio = 3.0; // 線形なら約2、二乗なら約4
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            size = std::max<size_t>(1024, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--max-ratio") == 0 && i + 1 < argc)
+        {
+            maxRatio = std::atof(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "使い方: scaling_bench [--size <バイト数>] [--reps <回数>] [--max-ratio <比>]" << std::endl;
+            return 1;
+        }
+    }
+
+    bool passed = true;
+    size_t sink = 0;
+    std::cout << std::fixed << std::setprecision(3);
+    for (const auto &c : buildCases())
+    {
+        const std::string small = c.generate(size);
+        const std::string large = c.generate(size * 2);
+
+        if (!matchesStagedNormalization(small))
+        {
+            std::cerr << c.name << ": 段階的な処理と結果が一致しません" << std::endl;
+            passed = false;
+            continue;
+        }
+
+        const double smallTime = measure(c, small, reps, sink);
+        const double largeTime = measure(c, large, reps, sink);
+        const double ratio = (smallTime > 0.0) ? largeTime / smallTime : 0.0;
+        const bool ok = ratio <= maxRatio;
+        passed = passed && ok;
+
+        std::cout << c.name << ": N=" << smallTime * 1e3 << " ms, 2N=" << largeTime * 1e3
+                  << " ms, 比=" << ratio << (ok ? "" : "  <- 線形ではありません") << std::endl;
+    }
+
+    return (passed && sink != 0) ? 0 : 1;
+}
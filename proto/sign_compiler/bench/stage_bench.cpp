@@ -0,0 +1,308 @@
+// bench/stage_bench.cpp
+/**
+ * プリプロセッサの段階別ベンチマーク
+ *
+ * 機能:
+ * - 公開されている各段階を単独で計測（前段の結果は計測の外で用意する）
+ *   normalizeSourceCode, extractCodeBlocks, tokenizeBlock, processLambdaExpressions,
+ *   processPartialApplications, extractDefinitions, resolveDefinitions, applyDefinitions,
+ *   generateFinalCode
+ * - preprocessSourceCode による全体の処理も計測
+ * - スループット（入力サイズ基準のMB/秒、各段階の入力トークン数基準のトークン/秒）を表示
+ * - 結果をJSONで出力（性能の退行の追跡用）
+ *
+ * 使い方:
+ * stage_bench [--reps <最低回数>] [--min-time <秒>] [--warmup <回数>] [--scale <倍率>]
+ *             [--json <出力ファイル>] [<ファイルまたはディレクトリ>...]
+ * (省略時は example ディレクトリ)
+ *
+ * ver_20261016_0
+ */
+
+#include "bench/bench_utils.h"
+#include "common/lexer/tokenizer.h"
+#include "common/parser/block_extractor.h"
+#include "common/version.h"
+#include "preprocessor/lambda_processor.h"
+#include "preprocessor/preprocessor.h"
+#include "preprocessor/sign_transformer.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    using namespace sign;
+
+    // 計測の設定
+    struct MeasureOptions
+    {
+        int warmup = 2;
+        int minReps = 15;
+        double minSeconds = 0.2;
+        int maxReps = 10000;
+    };
+
+    // 1段階の計測結果
+    struct StageResult
+    {
+        std::string name;
+        size_t tokens = 0; // 段階の入力トークン数（トークン化以前は出力トークン数）
+        bench::Summary summary;
+    };
+
+    // 1入力の計測結果
+    struct InputResult
+    {
+        std::string path;
+        size_t bytes = 0;
+        size_t blocks = 0;
+        size_t tokens = 0;
+        std::vector<StageResult> stages;
+    };
+
+    size_t countTokens(const std::vector<std::vector<common::Token>> &blocks)
+    {
+        size_t count = 0;
+        for (const auto &tokens : blocks)
+        {
+            count += tokens.size();
+        }
+        return count;
+    }
+
+    // ブロックごとの処理を全ブロックに適用する
+    std::vector<std::vector<common::Token>> mapBlocks(const std::vector<std::vector<common::Token>> &blocks,
+                                                      const std::function<std::vector<common::Token>(const std::vector<common::Token> &)> &stage)
+    {
+        std::vector<std::vector<common::Token>> result;
+        result.reserve(blocks.size());
+        for (const auto &tokens : blocks)
+        {
+            result.push_back(stage(tokens));
+        }
+        return result;
+    }
+
+    InputResult benchInput(const std::string &path, const std::string &source, const MeasureOptions &options)
+    {
+        InputResult result;
+        result.path = path;
+        result.bytes = source.size();
+
+        // 各段階の入力を計測の外で順に用意する
+        const std::string normalized = normalizeSourceCode(source);
+        const std::vector<std::string> blocks = common::extractCodeBlocks(normalized);
+        std::vector<std::vector<common::Token>> tokens;
+        tokens.reserve(blocks.size());
+        for (const auto &block : blocks)
+        {
+            tokens.push_back(common::tokenizeBlock(std::string_view(block)));
+        }
+        const auto afterLambda = mapBlocks(tokens, [](const std::vector<common::Token> &t)
+                                           { return processLambdaExpressions(t); });
+        const auto afterPartial = mapBlocks(afterLambda, [](const std::vector<common::Token> &t)
+                                            { return processPartialApplications(t); });
+        const DefinitionTable definitions = extractDefinitions(afterPartial);
+        const auto resolved = resolveDefinitions(definitions);
+        const auto applied = mapBlocks(afterPartial, [&](const std::vector<common::Token> &t)
+                                       { return applyDefinitions(t, *resolved); });
+
+        result.blocks = blocks.size();
+        result.tokens = countTokens(tokens);
+
+        // 計測結果がすべて捨てられないように、出力の大きさを集計する
+        size_t sink = 0;
+        const auto run = [&](const char *name, size_t stageTokens, const std::function<size_t()> &body)
+        {
+            StageResult stage;
+            stage.name = name;
+            stage.tokens = stageTokens;
+            stage.summary = bench::summarize(bench::measure([&]
+                                                            { sink += body(); },
+                                                            options.warmup, options.minReps, options.minSeconds, options.maxReps));
+            result.stages.push_back(stage);
+        };
+
+        run("normalizeSourceCode", result.tokens, [&]
+            { return normalizeSourceCode(source).size(); });
+        run("extractCodeBlocks", result.tokens, [&]
+            { return common::extractCodeBlocks(normalized).size(); });
+        run("tokenizeBlock", result.tokens, [&]
+            {
+                size_t count = 0;
+                for (const auto &block : blocks)
+                {
+                    count += common::tokenizeBlock(std::string_view(block)).size();
+                }
+                return count; });
+        run("processLambdaExpressions", countTokens(tokens), [&]
+            { return mapBlocks(tokens, [](const std::vector<common::Token> &t)
+                               { return processLambdaExpressions(t); })
+                  .size(); });
+        run("processPartialApplications", countTokens(afterLambda), [&]
+            { return mapBlocks(afterLambda, [](const std::vector<common::Token> &t)
+                               { return processPartialApplications(t); })
+                  .size(); });
+        run("extractDefinitions", countTokens(afterPartial), [&]
+            { return extractDefinitions(afterPartial).size(); });
+        run("resolveDefinitions", countTokens(afterPartial), [&]
+            { return resolveDefinitions(definitions)->size(); });
+        run("applyDefinitions", countTokens(afterPartial), [&]
+            { return mapBlocks(afterPartial, [&](const std::vector<common::Token> &t)
+                               { return applyDefinitions(t, *resolved); })
+                  .size(); });
+        run("generateFinalCode", countTokens(applied), [&]
+            { return generateFinalCode(applied).size(); });
+        run("preprocessSourceCode", result.tokens, [&]
+            { return preprocessSourceCode(source).size(); });
+
+        if (sink == 0)
+        {
+            std::cerr << "計測結果が空です: " << path << std::endl;
+        }
+        return result;
+    }
+
+    void printResult(const InputResult &result)
+    {
+        std::cout << result.path << " (" << result.bytes << " bytes, " << result.blocks << " ブロック, "
+                  << result.tokens << " トークン)" << std::endl;
+        std::cout << std::fixed;
+        for (const auto &stage : result.stages)
+        {
+            const double seconds = stage.summary.median;
+            const double megabytes = static_cast<double>(result.bytes) / (1024.0 * 1024.0);
+            std::cout << "  " << std::left << std::setw(28) << stage.name << std::right
+                      << std::setprecision(3) << std::setw(10) << seconds * 1e3 << " ms"
+                      << " ±" << std::setprecision(1) << std::setw(5)
+                      << (seconds > 0.0 ? stage.summary.mad / seconds * 100.0 : 0.0) << "%"
+                      << std::setprecision(2) << std::setw(10) << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s"
+                      << std::setprecision(2) << std::setw(10)
+                      << (seconds > 0.0 ? static_cast<double>(stage.tokens) / seconds / 1e6 : 0.0) << " Mトークン/s"
+                      << "  (" << stage.summary.count << " 回)" << std::endl;
+        }
+    }
+
+    void writeJson(std::ostream &out, const std::vector<InputResult> &results, const MeasureOptions &options)
+    {
+        out << std::setprecision(9);
+        out << "{\n";
+        out << "  \"benchmark\": \"stage_bench\",\n";
+        out << "  \"compiler_version\": " << bench::jsonString(common::COMPILER_VERSION) << ",\n";
+        out << "  \"warmup\": " << options.warmup << ",\n";
+        out << "  \"min_reps\": " << options.minReps << ",\n";
+        out << "  \"min_time_s\": " << options.minSeconds << ",\n";
+        out << "  \"inputs\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const InputResult &result = results[i];
+            out << (i > 0 ? "," : "") << "\n    {\n";
+            out << "      \"path\": " << bench::jsonString(result.path) << ",\n";
+            out << "      \"bytes\": " << result.bytes << ",\n";
+            out << "      \"blocks\": " << result.blocks << ",\n";
+            out << "      \"tokens\": " << result.tokens << ",\n";
+            out << "      \"stages\": [";
+            for (size_t k = 0; k < result.stages.size(); ++k)
+            {
+                const StageResult &stage = result.stages[k];
+                const double seconds = stage.summary.median;
+                out << (k > 0 ? "," : "") << "\n        {"
+                    << "\"name\": " << bench::jsonString(stage.name)
+                    << ", \"reps\": " << stage.summary.count
+                    << ", \"median_s\": " << seconds
+                    << ", \"min_s\": " << stage.summary.min
+                    << ", \"max_s\": " << stage.summary.max
+                    << ", \"mad_s\": " << stage.summary.mad
+                    << ", \"tokens\": " << stage.tokens
+                    << ", \"mb_per_s\": " << (seconds > 0.0 ? static_cast<double>(result.bytes) / (1024.0 * 1024.0) / seconds : 0.0)
+                    << ", \"tokens_per_s\": " << (seconds > 0.0 ? static_cast<double>(stage.tokens) / seconds : 0.0)
+                    << "}";
+            }
+            out << "\n      ]\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    MeasureOptions options;
+    size_t scale = 1;
+    std::string jsonPath;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            options.minReps = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            options.minSeconds = std::max(0.0, std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+        {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+        {
+            scale = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (std::strncmp(argv[i], "--", 2) == 0)
+        {
+            std::cerr << "使い方: stage_bench [--reps <最低回数>] [--min-time <秒>] [--warmup <回数>] [--scale <倍率>]"
+                         " [--json <出力ファイル>] [<ファイルまたはディレクトリ>...]"
+                      << std::endl;
+            return 1;
+        }
+        else
+        {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty())
+    {
+        paths.push_back("example");
+    }
+
+    std::vector<bench::InputFile> inputs = bench::loadInputs(paths);
+    if (inputs.empty())
+    {
+        std::cerr << "入力ファイルがありません" << std::endl;
+        return 1;
+    }
+
+    std::vector<InputResult> results;
+    for (const auto &input : inputs)
+    {
+        // 小さな入力は複製して大きくする（ブロックの区切りを保つため空行で連結）
+        std::string source = input.content;
+        for (size_t k = 1; k < scale; ++k)
+        {
+            source += "\n\n" + input.content;
+        }
+        results.push_back(benchInput(input.path, source, options));
+        printResult(results.back());
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream json(jsonPath);
+        if (!json.is_open())
+        {
+            std::cerr << "JSONファイルを開けませんでした: " << jsonPath << std::endl;
+            return 1;
+        }
+        writeJson(json, results, options);
+        std::cout << "JSON出力: " << jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+@echo
+setlocal
+
+REM ベンチマークのビルド設定（最適化あり）
+set CXX=g++
+set CXXFLAGS=-std=c++17 -Wall -Wextra -Wpedantic -O2 -DNDEBUG -pthread
+set INCLUDES=-I. -Isrc
+
+REM プリプロセッサ本体のソース（main.cpp 以外）
+set SOURCES=^
+src\common\lexer\structural_index.cpp ^
+src\common\lexer\symbol_table.cpp ^
+src\common\lexer\token.cpp ^
+src\common\lexer\token_stream.cpp ^
+src\common\lexer\tokenizer.cpp ^
+src\common\parser\block_extractor.cpp ^
+src\common\parser\source_normalizer.cpp ^
+src\common\utils\allocation_counter.cpp ^
+src\common\utils\file_utils.cpp ^
+src\common\utils\output_sink.cpp ^
+src\common\utils\string_utils.cpp ^
+src\common\utils\thread_pool.cpp ^
+src\common\utils\trace.cpp ^
+src\preprocessor\preprocessor.cpp ^
+src\preprocessor\lambda_processor.cpp ^
+src\preprocessor\inliner.cpp ^
+src\preprocessor\occurrence_index.cpp ^
+src\preprocessor\sign_transformer.cpp ^
+src\preprocessor\batch_processor.cpp ^
+src\preprocessor\incremental_preprocessor.cpp ^
+src\preprocessor\preprocess_cache.cpp ^
+src\preprocessor\preprocess_stats.cpp
+
+REM 実行ファイルにだけリンクするソース（メモリ確保量を数える operator new の置き換え）
+set EXECUTABLE_SOURCES=src\common\utils\allocation_hook.cpp
+
+REM 出力ディレクトリ
+if not exist bin mkdir bin
+
+REM コンパイル実行
+echo ベンチマークのビルドを開始します...
+%CXX% %CXXFLAGS% %INCLUDES% %SOURCES% %EXECUTABLE_SOURCES% bench\lexer_bench.cpp -o bin\lexer_bench.exe
+if %ERRORLEVEL% NEQ 0 goto failed
+%CXX% %CXXFLAGS% %INCLUDES% %SOURCES% %EXECUTABLE_SOURCES% bench\scaling_bench.cpp -o bin\scaling_bench.exe
+if %ERRORLEVEL% NEQ 0 goto failed
+%CXX% %CXXFLAGS% %INCLUDES% %SOURCES% %EXECUTABLE_SOURCES% bench\incremental_bench.cpp -o bin\incremental_bench.exe
+if %ERRORLEVEL% NEQ 0 goto failed
+%CXX% %CXXFLAGS% %INCLUDES% %SOURCES% %EXECUTABLE_SOURCES% bench\rewrite_bench.cpp -o bin\rewrite_bench.exe
+if %ERRORLEVEL% NEQ 0 goto failed
+%CXX% %CXXFLAGS% %INCLUDES% %SOURCES% %EXECUTABLE_SOURCES% bench\lambda_bench.cpp -o bin\lambda_bench.exe
+if %ERRORLEVEL% NEQ 0 goto failed
+%CXX% %CXXFLAGS% %INCLUDES% %SOURCES% %EXECUTABLE_SOURCES% bench\definition_bench.cpp -o bin\definition_bench.exe
+if %ERRORLEVEL% NEQ 0 goto failed
+%CXX% %CXXFLAGS% %INCLUDES% %SOURCES% %EXECUTABLE_SOURCES% bench\stage_bench.cpp -o bin\stage_bench.exe
+if %ERRORLEVEL% NEQ 0 goto failed
+%CXX% %CXXFLAGS% %INCLUDES% %SOURCES% %EXECUTABLE_SOURCES% bench\corpus_gen.cpp -o bin\corpus_gen.exe
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo ビルド成功: bin\lexer_bench.exe, bin\scaling_bench.exe, bin\incremental_bench.exe, bin\rewrite_bench.exe, bin\lambda_bench.exe, bin\definition_bench.exe, bin\stage_bench.exe, bin\corpus_gen.exe が作成されました
+goto end
+
+:failed
+echo ビルド失敗: エラーコード %ERRORLEVEL%
+
+:end
+endlocal
@@ -0,0 +1,53 @@
+#!/bin/sh
+# ベンチマークのビルド（Linux などの POSIX 環境用、build-bench.bat と同じ構成）
+set -e
+cd "$(dirname "$0")"
+
+CXX=${CXX:-g++}
+CXXFLAGS="-std=c++17 -Wall -Wextra -Wpedantic -O2 -DNDEBUG -pthread"
+INCLUDES="-I. -Isrc"
+
+# プリプロセッサ本体のソース（main.cpp 以外）
+SOURCES="
+src/common/lexer/structural_index.cpp
+src/common/lexer/symbol_table.cpp
+src/common/lexer/token.cpp
+src/common/lexer/token_stream.cpp
+src/common/lexer/tokenizer.cpp
+src/common/parser/block_extractor.cpp
+src/common/parser/source_normalizer.cpp
+src/common/utils/allocation_counter.cpp
+src/common/utils/file_utils.cpp
+src/common/utils/output_sink.cpp
+src/common/utils/string_utils.cpp
+src/common/utils/thread_pool.cpp
+src/common/utils/trace.cpp
+src/preprocessor/preprocessor.cpp
+src/preprocessor/lambda_processor.cpp
+src/preprocessor/inliner.cpp
+src/preprocessor/occurrence_index.cpp
+src/preprocessor/sign_transformer.cpp
+src/preprocessor/batch_processor.cpp
+src/preprocessor/incremental_preprocessor.cpp
+src/preprocessor/preprocess_cache.cpp
+src/preprocessor/preprocess_stats.cpp
+"
+
+# 実行ファイルにだけリンクするソース（メモリ確保量を数える operator new の置き換え）
+EXECUTABLE_SOURCES="src/common/utils/allocation_hook.cpp"
+
+BENCHES="lexer_bench scaling_bench incremental_bench rewrite_bench lambda_bench definition_bench stage_bench corpus_gen"
+
+# 出力ディレクトリ
+mkdir -p bin
+
+echo "ベンチマークのビルドを開始します..."
+for bench in $BENCHES; do
+    # shellcheck disable=SC2086
+    if ! $CXX $CXXFLAGS $INCLUDES $SOURCES $EXECUTABLE_SOURCES "bench/$bench.cpp" -o "bin/$bench"; then
+        echo "ビルド失敗: bench/$bench.cpp"
+        exit 1
+    fi
+done
+
+echo "ビルド成功: $(for bench in $BENCHES; do printf 'bin/%s ' "$bench"; done)が作成されました"
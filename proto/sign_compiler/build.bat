@@ -17,15 +17,31 @@ if not exist bin mkdir bin
 REM コンパイル実行
 echo ビルドを開始します...
 %CXX% %CXXFLAGS% %INCLUDES% ^
+src\common\lexer\structural_index.cpp ^
+src\common\lexer\symbol_table.cpp ^
 src\common\lexer\token.cpp ^
+src\common\lexer\token_stream.cpp ^
 src\common\lexer\tokenizer.cpp ^
 src\common\parser\block_extractor.cpp ^
+src\common\parser\source_normalizer.cpp ^
+src\common\utils\allocation_counter.cpp ^
 src\common\utils\file_utils.cpp ^
+src\common\utils\output_sink.cpp ^
 src\common\utils\string_utils.cpp ^
+src\common\utils\thread_pool.cpp ^
+src\common\utils\trace.cpp ^
 src\preprocessor\preprocessor.cpp ^
 src\preprocessor\lambda_processor.cpp ^
+src\preprocessor\inliner.cpp ^
+src\preprocessor\occurrence_index.cpp ^
 src\preprocessor\sign_transformer.cpp ^
+src\preprocessor\batch_processor.cpp ^
+src\preprocessor\incremental_preprocessor.cpp ^
+src\preprocessor\preprocess_cache.cpp ^
+src\preprocessor\preprocess_stats.cpp ^
+src\common\utils\allocation_hook.cpp ^
 src\main.cpp ^
+-pthread ^
 -o bin\sign_compiler.exe
 
 if %ERRORLEVEL% EQU 0 (
@@ -0,0 +1,273 @@
+// src/common/lexer/structural_index.cpp
+/**
+ * Sign言語のソース中の構造文字の位置を索引化する実装
+ *
+ * 64バイト単位で構造文字と改行のビットマスクを求める
+ * - AVX2: 上位/下位ニブルのテーブル引き (vpshufb) による分類
+ * - SSE2: 構造文字ごとの比較
+ * - その他: 文字種別テーブルによるスカラー処理
+ * ニブルテーブルと比較対象の文字は文字種別テーブルからコンパイル時に生成する
+ *
+ * ver_20261016_0
+ */
+
+#include "common/lexer/structural_index.h"
+#include <array>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define SIGN_STRUCTURAL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace sign
+{
+    namespace common
+    {
+
+        namespace
+        {
+            // 構造文字の一覧を生成する
+            constexpr size_t countStructuralChars()
+            {
+                size_t count = 0;
+                for (int c = 0; c < 256; ++c)
+                {
+                    count += isStructural(static_cast<char>(c)) ? 1 : 0;
+                }
+                return count;
+            }
+
+            constexpr std::array<char, countStructuralChars()> buildStructuralChars()
+            {
+                std::array<char, countStructuralChars()> chars{};
+                size_t n = 0;
+                for (int c = 0; c < 256; ++c)
+                {
+                    if (isStructural(static_cast<char>(c)))
+                    {
+                        chars[n++] = static_cast<char>(c);
+                    }
+                }
+                return chars;
+            }
+
+            constexpr auto STRUCTURAL_CHARS = buildStructuralChars();
+
+            // ニブル分類テーブル: 上位ニブルごとに1ビットを割り当て、
+            // 下位ニブルテーブルにはその上位ニブルで構造文字となる下位ニブルのビットを立てる
+            struct NibbleTables
+            {
+                std::array<std::uint8_t, 16> high{};
+                std::array<std::uint8_t, 16> low{};
+                bool valid = true; // 上位ニブルの種類が8以下ならtrue
+            };
+
+            constexpr NibbleTables buildNibbleTables()
+            {
+                NibbleTables tables;
+                int nextBit = 0;
+                for (int high = 0; high < 16; ++high)
+                {
+                    bool used = false;
+                    for (int low = 0; low < 16; ++low)
+                    {
+                        used = used || isStructural(static_cast<char>(high * 16 + low));
+                    }
+                    if (!used)
+                    {
+                        continue;
+                    }
+                    if (nextBit >= 8)
+                    {
+                        tables.valid = false;
+                        break;
+                    }
+                    const auto bit = static_cast<std::uint8_t>(1u << nextBit++);
+                    tables.high[high] = bit;
+                    for (int low = 0; low < 16; ++low)
+                    {
+                        if (isStructural(static_cast<char>(high * 16 + low)))
+                        {
+                            tables.low[low] |= bit;
+                        }
+                    }
+                }
+                return tables;
+            }
+
+            constexpr NibbleTables NIBBLE_TABLES = buildNibbleTables();
+            static_assert(NIBBLE_TABLES.valid, "構造文字の上位ニブルが8種類を超えています");
+
+            // 64バイト分のビットマスク
+            struct Masks
+            {
+                std::uint64_t structural;
+                std::uint64_t newlines;
+            };
+
+            // スカラー処理（末尾の端数もこれで処理する）
+            Masks classifyScalar(const char *data, size_t count)
+            {
+                Masks masks{0, 0};
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (isStructural(data[i]))
+                    {
+                        masks.structural |= std::uint64_t(1) << i;
+                    }
+                    if (data[i] == '\n')
+                    {
+                        masks.newlines |= std::uint64_t(1) << i;
+                    }
+                }
+                return masks;
+            }
+
+#ifdef SIGN_STRUCTURAL_X86
+            // SSE2: 16バイトごとに構造文字それぞれと比較
+            Masks classifySse2(const char *data)
+            {
+                Masks masks{0, 0};
+                const __m128i newline = _mm_set1_epi8('\n');
+                for (int part = 0; part < 4; ++part)
+                {
+                    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + part * 16));
+                    __m128i hit = _mm_setzero_si128();
+                    for (char c : STRUCTURAL_CHARS)
+                    {
+                        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)));
+                    }
+                    const auto bits = static_cast<std::uint32_t>(_mm_movemask_epi8(hit));
+                    const auto lines = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+                    masks.structural |= std::uint64_t(bits) << (part * 16);
+                    masks.newlines |= std::uint64_t(lines) << (part * 16);
+                }
+                return masks;
+            }
+
+            // AVX2: 32バイトごとにニブルテーブルを引いて分類
+            __attribute__((target("avx2"))) Masks classifyAvx2(const char *data)
+            {
+                const auto &t = NIBBLE_TABLES;
+                const __m256i highTable = _mm256_setr_epi8(
+                    t.high[0], t.high[1], t.high[2], t.high[3], t.high[4], t.high[5], t.high[6], t.high[7],
+                    t.high[8], t.high[9], t.high[10], t.high[11], t.high[12], t.high[13], t.high[14], t.high[15],
+                    t.high[0], t.high[1], t.high[2], t.high[3], t.high[4], t.high[5], t.high[6], t.high[7],
+                    t.high[8], t.high[9], t.high[10], t.high[11], t.high[12], t.high[13], t.high[14], t.high[15]);
+                const __m256i lowTable = _mm256_setr_epi8(
+                    t.low[0], t.low[1], t.low[2], t.low[3], t.low[4], t.low[5], t.low[6], t.low[7],
+                    t.low[8], t.low[9], t.low[10], t.low[11], t.low[12], t.low[13], t.low[14], t.low[15],
+                    t.low[0], t.low[1], t.low[2], t.low[3], t.low[4], t.low[5], t.low[6], t.low[7],
+                    t.low[8], t.low[9], t.low[10], t.low[11], t.low[12], t.low[13], t.low[14], t.low[15]);
+                const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+                const __m256i newline = _mm256_set1_epi8('\n');
+
+                Masks masks{0, 0};
+                for (int part = 0; part < 2; ++part)
+                {
+                    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + part * 32));
+                    const __m256i high = _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibbleMask);
+                    const __m256i low = _mm256_and_si256(chunk, nibbleMask);
+                    const __m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(highTable, high),
+                                                             _mm256_shuffle_epi8(lowTable, low));
+                    const __m256i none = _mm256_cmpeq_epi8(classes, _mm256_setzero_si256());
+                    const auto bits = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(none));
+                    const auto lines = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+                    masks.structural |= std::uint64_t(bits) << (part * 32);
+                    masks.newlines |= std::uint64_t(lines) << (part * 32);
+                }
+                return masks;
+            }
+
+            bool hasAvx2()
+            {
+                static const bool supported = __builtin_cpu_supports("avx2");
+                return supported;
+            }
+#endif
+
+            // 64バイト単位の分類（実行環境に応じて実装を選ぶ）
+            template <typename Classify>
+            void buildBitmaps(std::string_view text, std::vector<std::uint64_t> &structural,
+                              std::vector<std::uint64_t> &newlines, Classify classify)
+            {
+                const size_t full = text.size() / 64;
+                for (size_t word = 0; word < full; ++word)
+                {
+                    const Masks masks = classify(text.data() + word * 64);
+                    structural[word] = masks.structural;
+                    newlines[word] = masks.newlines;
+                }
+                if (text.size() % 64)
+                {
+                    const Masks masks = classifyScalar(text.data() + full * 64, text.size() % 64);
+                    structural[full] = masks.structural;
+                    newlines[full] = masks.newlines;
+                }
+            }
+
+            inline int countTrailingZeros(std::uint64_t word)
+            {
+#if defined(__GNUC__)
+                return __builtin_ctzll(word);
+#else
+                int count = 0;
+                while (!(word & 1))
+                {
+                    word >>= 1;
+                    ++count;
+                }
+                return count;
+#endif
+            }
+        } // namespace
+
+        StructuralIndex::StructuralIndex(std::string_view text)
+            : structural((text.size() + 63) / 64, 0), newlines((text.size() + 63) / 64, 0), length(text.size())
+        {
+#ifdef SIGN_STRUCTURAL_X86
+            if (hasAvx2())
+            {
+                buildBitmaps(text, structural, newlines, classifyAvx2);
+            }
+            else
+            {
+                buildBitmaps(text, structural, newlines, classifySse2);
+            }
+#else
+            buildBitmaps(text, structural, newlines, [](const char *data)
+                         { return classifyScalar(data, 64); });
+#endif
+        }
+
+        const char *StructuralIndex::implementation()
+        {
+#ifdef SIGN_STRUCTURAL_X86
+            return hasAvx2() ? "avx2" : "sse2";
+#else
+            return "scalar";
+#endif
+        }
+
+        size_t StructuralIndex::nextSet(const std::vector<std::uint64_t> &bits, size_t pos) const
+        {
+            if (pos >= length)
+            {
+                return npos;
+            }
+
+            size_t word = pos / 64;
+            std::uint64_t current = bits[word] & (~std::uint64_t(0) << (pos % 64));
+            while (current == 0)
+            {
+                if (++word >= bits.size())
+                {
+                    return npos;
+                }
+                current = bits[word];
+            }
+            return word * 64 + countTrailingZeros(current);
+        }
+
+    } // namespace common
+} // namespace sign
@@ -0,0 +1,85 @@
+// src/common/lexer/structural_index.h
+/**
+ * Sign言語のソース中の構造文字の位置を索引化するモジュール
+ *
+ * 機能:
+ * - 構造文字（空白・改行・カッコ・区切り文字・リテラル開始文字）のビットマップ生成
+ * - SSE2/AVX2 によるベクトル化（非対応環境ではスカラー処理）
+ * - 次の構造文字・次の改行位置の高速検索
+ *
+ * コメント除去・カッコ統一・ブロック分割・トークン化は
+ * 1バイトずつ走査する代わりにこの索引を辿る
+ *
+ * ver_20261016_0
+ */
+#ifndef SIGN_COMMON_LEXER_STRUCTURAL_INDEX_H
+#define SIGN_COMMON_LEXER_STRUCTURAL_INDEX_H
+
+#include "common/lexer/token.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sign
+{
+    namespace common
+    {
+
+        // 構造文字に該当する文字種別
+        inline constexpr std::uint8_t STRUCTURAL_CLASS = CHAR_WHITESPACE | CHAR_SEPARATE | CHAR_LITERAL_START;
+
+        // 構造文字かどうか
+        constexpr bool isStructural(char c)
+        {
+            return charClass(c) & STRUCTURAL_CLASS;
+        }
+
+        // 構造文字の位置を1ビット/1バイトで保持する索引
+        class StructuralIndex
+        {
+        public:
+            static constexpr size_t npos = std::string_view::npos;
+
+            StructuralIndex() = default;
+
+            /**
+             * テキスト全体を1回走査して索引を構築する
+             *
+             * @param text 索引化するテキスト
+             */
+            explicit StructuralIndex(std::string_view text);
+
+            // 索引化したテキストの長さ
+            size_t size() const { return length; }
+
+            /**
+             * pos以降で最初の構造文字の位置を返す
+             *
+             * @param pos 検索開始位置
+             * @return 構造文字の位置（なければnpos）
+             */
+            size_t nextStructural(size_t pos) const { return nextSet(structural, pos); }
+
+            /**
+             * pos以降で最初の改行の位置を返す
+             *
+             * @param pos 検索開始位置
+             * @return 改行の位置（なければnpos）
+             */
+            size_t nextNewline(size_t pos) const { return nextSet(newlines, pos); }
+
+            // 使用中のSIMD実装名（"avx2" / "sse2" / "scalar"）
+            static const char *implementation();
+
+        private:
+            size_t nextSet(const std::vector<std::uint64_t> &bits, size_t pos) const;
+
+            std::vector<std::uint64_t> structural; // 構造文字のビットマップ
+            std::vector<std::uint64_t> newlines;   // 改行のビットマップ
+            size_t length = 0;
+        };
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_LEXER_STRUCTURAL_INDEX_H
@@ -0,0 +1,131 @@
+// src/common/lexer/symbol_table.cpp
+/**
+ * Sign言語のシンボルテーブルを実装
+ *
+ * ver_20261016_2
+ */
+
+#include "common/lexer/symbol_table.h"
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace sign
+{
+    namespace common
+    {
+
+        SymbolTable::SymbolTable()
+            : chunks(new std::atomic<std::string *>[MAX_CHUNKS])
+        {
+            for (size_t i = 0; i < MAX_CHUNKS; ++i)
+            {
+                chunks[i].store(nullptr, std::memory_order_relaxed);
+            }
+
+            // 空の識別子は常にID 0
+            intern("");
+        }
+
+        SymbolTable::~SymbolTable()
+        {
+            for (size_t i = 0; i < MAX_CHUNKS; ++i)
+            {
+                delete[] chunks[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        // 識別子を登録してIDを返す
+        SymbolId SymbolTable::intern(std::string_view name)
+        {
+            // 登録済みの識別子は共有ロックのみで返す
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                auto it = ids.find(name);
+                if (it != ids.end())
+                {
+                    return it->second;
+                }
+            }
+
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            auto it = ids.find(name);
+            if (it != ids.end())
+            {
+                return it->second;
+            }
+
+            const size_t index = count.load(std::memory_order_relaxed);
+            if (index >= MAX_CHUNKS * CHUNK_SIZE - 1)
+            {
+                throw std::length_error("シンボルテーブルの容量を超えました");
+            }
+
+            std::string *chunk = chunks[index >> CHUNK_BITS].load(std::memory_order_relaxed);
+            if (chunk == nullptr)
+            {
+                chunk = new std::string[CHUNK_SIZE];
+                chunks[index >> CHUNK_BITS].store(chunk, std::memory_order_release);
+            }
+
+            std::string &slot = chunk[index & (CHUNK_SIZE - 1)];
+            slot.assign(name.data(), name.size());
+
+            const SymbolId id = static_cast<SymbolId>(index);
+            ids.emplace(slot, id);
+            count.store(index + 1, std::memory_order_release);
+            return id;
+        }
+
+        // 登録済みの識別子のIDを検索する
+        SymbolId SymbolTable::find(std::string_view name) const
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = ids.find(name);
+            return it != ids.end() ? it->second : INVALID_SYMBOL;
+        }
+
+        // 後から登録した識別子を破棄する
+        void SymbolTable::truncate(size_t mark)
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            const size_t current = count.load(std::memory_order_relaxed);
+            mark = std::max<size_t>(mark, 1);
+            if (mark >= current)
+            {
+                return;
+            }
+
+            count.store(mark, std::memory_order_release);
+            for (size_t index = mark; index < current; ++index)
+            {
+                std::string &slot = chunks[index >> CHUNK_BITS].load(std::memory_order_relaxed)[index & (CHUNK_SIZE - 1)];
+                ids.erase(slot);
+                std::string().swap(slot);
+            }
+
+            // 使われなくなったチャンクを解放する
+            for (size_t chunk = (mark + CHUNK_SIZE - 1) >> CHUNK_BITS; chunk <= (current - 1) >> CHUNK_BITS; ++chunk)
+            {
+                delete[] chunks[chunk].exchange(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        // IDに対応する識別子を返す
+        std::string_view SymbolTable::name(SymbolId id) const
+        {
+            if (id >= count.load(std::memory_order_acquire))
+            {
+                return std::string_view();
+            }
+            return chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+        }
+
+        SymbolTable &globalSymbols()
+        {
+            static SymbolTable table;
+            return table;
+        }
+
+    } // namespace common
+} // namespace sign
@@ -0,0 +1,114 @@
+// src/common/lexer/symbol_table.h
+/**
+ * Sign言語の識別子を整数IDに変換するシンボルテーブルを提供するモジュール
+ *
+ * 機能:
+ * - 識別子文字列のインターン（字句解析時に一度だけ登録）
+ * - 連番の整数IDによる識別子の比較と検索
+ * - IDから識別子文字列への逆引き
+ * - 複数スレッドからの同時登録・参照
+ * - 長時間動作するホスト向けに、ある時点より後に登録した識別子の破棄
+ *
+ * 登録した識別子は truncate するまで解放されない（使用量は登録した異なる識別子の数に比例する）。
+ * 1回のコンパイルやバッチ処理では問題にならないが、編集のたびに識別子が増える差分プリプロセスの
+ * セッションなどは、IncrementalPreprocessor::rebuild で定期的に破棄する。
+ *
+ * ver_20261016_2
+ */
+#ifndef SIGN_COMMON_LEXER_SYMBOL_TABLE_H
+#define SIGN_COMMON_LEXER_SYMBOL_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace sign
+{
+    namespace common
+    {
+
+        // 識別子のID（0から始まる連番）
+        using SymbolId = std::uint32_t;
+
+        // 識別子を持たないトークンのID
+        constexpr SymbolId INVALID_SYMBOL = UINT32_MAX;
+
+        // 空の識別子（演算子のみからなるトークン）のID
+        constexpr SymbolId EMPTY_SYMBOL = 0;
+
+        // 識別子文字列と整数IDを相互に変換するテーブル
+        // 登録・検索は読み書きロックで保護し、IDからの逆引きはロックなしで行える
+        class SymbolTable
+        {
+        public:
+            SymbolTable();
+            ~SymbolTable();
+
+            SymbolTable(const SymbolTable &) = delete;
+            SymbolTable &operator=(const SymbolTable &) = delete;
+
+            /**
+             * 識別子を登録してIDを返す（登録済みなら既存のID）
+             *
+             * @param name 識別子
+             * @return 識別子のID
+             */
+            SymbolId intern(std::string_view name);
+
+            /**
+             * 登録済みの識別子のIDを検索する
+             *
+             * @param name 識別子
+             * @return 識別子のID（未登録ならINVALID_SYMBOL）
+             */
+            SymbolId find(std::string_view name) const;
+
+            /**
+             * IDに対応する識別子を返す
+             * 登録済みの識別子は移動しないため、ロックなしで参照できる
+             *
+             * @param id 識別子のID（intern または find で得たもの）
+             * @return 識別子（テーブルの生存中は有効なビュー）
+             */
+            std::string_view name(SymbolId id) const;
+
+            // 登録済みの識別子の数
+            size_t size() const { return count.load(std::memory_order_acquire); }
+
+            /**
+             * size() が mark だった時点より後に登録した識別子を破棄する
+             * 破棄した識別子のID・ビューと、それを持つトークンは使用できなくなる。
+             * 呼び出し中と呼び出し後に、そのようなIDやトークンを使う処理が残っていないこと
+             * （関数内の static などに保持するIDは mark より前に登録しておくこと）
+             *
+             * @param mark 残す識別子の数（size() で得たもの、空の識別子は常に残る）
+             */
+            void truncate(size_t mark);
+
+        private:
+            // 識別子はチャンク単位で確保し、登録後は移動しない
+            static constexpr size_t CHUNK_BITS = 12;
+            static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+            static constexpr size_t MAX_CHUNKS = size_t(1) << 14; // 最大約6700万個
+
+            std::unique_ptr<std::atomic<std::string *>[]> chunks; // チャンクの先頭（MAX_CHUNKS個）
+            std::atomic<size_t> count{0};                         // 登録済みの識別子の数
+            std::unordered_map<std::string_view, SymbolId> ids;   // 識別子からIDへの対応
+            mutable std::shared_mutex mutex;                      // ids と登録処理の保護
+        };
+
+        /**
+         * コンパイル全体で共有するシンボルテーブルを返す
+         *
+         * @return グローバルシンボルテーブル
+         */
+        SymbolTable &globalSymbols();
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_LEXER_SYMBOL_TABLE_H
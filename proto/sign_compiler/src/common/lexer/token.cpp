@@ -3,87 +3,117 @@
  * Sign言語のトークン定義と基本操作を実装
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_4
  */
 
 #include "common/lexer/token.h"
-#include <cctype>
+#include <stdexcept>
+#include <string>
 
 namespace sign
 {
     namespace common
     {
 
-        // 演算子リストの定義
-        const std::unordered_set<std::string> INFIX_OPERATORS = {
-            ":", "?", " ", ",", "~", ";", "|", "&", "<", "<=", "=", ">=", ">", "!=",
-            "+", "-", "*", "/", "%", "^", "'", "@"};
+        namespace
+        {
+            // 合成トークンの文字列表（値は破棄するまで移動せず、同じ値は共有する）
+            SymbolTable &synthesizedTexts()
+            {
+                static SymbolTable table;
+                return table;
+            }
+        } // namespace
+
+        // 合成トークンの生成
+        Token Token::synthesize(std::string_view val, TokenType t, SymbolId symbol)
+        {
+            SymbolTable &texts = synthesizedTexts();
+            Token token(texts.name(texts.intern(val)), t);
+            token.symbol = symbol;
+            return token;
+        }
+
+        size_t Token::synthesizedCount()
+        {
+            return synthesizedTexts().size();
+        }
+
+        void Token::truncateSynthesized(size_t mark)
+        {
+            synthesizedTexts().truncate(mark);
+        }
 
-        const std::unordered_set<std::string> PREFIX_OPERATORS = {
-            "#", "~", "!", "$", "@", "[", "{", "("};
+        // 部分トークンの生成（同じバッファを参照する）
+        Token Token::slice(size_t pos, size_t count, TokenType t) const
+        {
+            return Token(value().substr(pos, count), t);
+        }
 
-        const std::unordered_set<std::string> POSTFIX_OPERATORS = {
-            "~", "!", "]", "}", ")"};
+        size_t Token::countPrefixLength() const
+        {
+            const std::string_view text = value();
+            const size_t limit = text.size() - postfixLength();
+            size_t length = 0;
+            while (length < limit && (charClass(text[length]) & CHAR_PREFIX) && !(charClass(text[length]) & CHAR_SEPARATE))
+            {
+                ++length;
+            }
+            return length;
+        }
 
-        // ブラケットとして扱う文字のリスト
-        const std::unordered_set<char> BRACKETS = {
-            '[', ']', '(', ')', '{', '}'};
+        void Token::throwTooLong(size_t length)
+        {
+            throw std::length_error("トークンが長すぎます（" + std::to_string(length) + " bytes, 上限 " +
+                                    std::to_string(MAX_LENGTH) + " bytes）");
+        }
 
-        bool isInfixOperator(const std::string &str)
+        bool isInfixOperator(std::string_view str)
         {
-            return INFIX_OPERATORS.find(str) != INFIX_OPERATORS.end();
+            return operatorFlags(str) & OP_INFIX;
         }
 
-        bool isPrefixOperator(const std::string &str)
+        bool isPrefixOperator(std::string_view str)
         {
-            return PREFIX_OPERATORS.find(str) != PREFIX_OPERATORS.end();
+            return operatorFlags(str) & OP_PREFIX;
         }
 
-        bool isPostfixOperator(const std::string &str)
+        bool isPostfixOperator(std::string_view str)
         {
-            return POSTFIX_OPERATORS.find(str) != POSTFIX_OPERATORS.end();
+            return operatorFlags(str) & OP_POSTFIX;
         }
 
         bool isDelimiter(char c)
         {
-            return c == ':' || c == '?' || c == ',';
+            return (charClass(c) & CHAR_SEPARATE) && !isBracket(c);
         }
 
         bool isBracket(char c)
         {
-            return BRACKETS.find(c) != BRACKETS.end();
+            const TokenType type = SEPARATE_TYPE[static_cast<unsigned char>(c)];
+            return type == TokenType::BRACKET_OPEN || type == TokenType::BRACKET_CLOSE;
         }
 
         bool isWhitespace(char c)
         {
-            return std::isspace(c);
+            return charClass(c) & CHAR_WHITESPACE;
         }
 
         // トークンタイプを判定する関数
-        TokenType determineTokenType(const std::string &token)
+        TokenType determineTokenType(std::string_view token)
         {
             if (token.empty())
                 return TokenType::UNKNOWN;
 
-            if (token == "?")
-            {
-                return TokenType::LAMBDA;
-            }
-            else if (token == ":")
-            {
-                return TokenType::DEFINE;
-            }
-            else if (token == ",")
+            if (token.size() == 1 && (charClass(token[0]) & CHAR_SEPARATE))
             {
-                return TokenType::COMMA;
+                return SEPARATE_TYPE[static_cast<unsigned char>(token[0])];
             }
             else if (isBracket(token[0]))
             {
-                return (token[0] == '[' || token[0] == '(' || token[0] == '{')
-                           ? TokenType::BRACKET_OPEN
-                           : TokenType::BRACKET_CLOSE;
+                return SEPARATE_TYPE[static_cast<unsigned char>(token[0])];
             }
-            else if (isInfixOperator(token) || isPrefixOperator(token) || isPostfixOperator(token))
+            else if (operatorFlags(token) != 0)
             {
                 return TokenType::OPERATOR;
             }
@@ -95,20 +125,20 @@ namespace sign
             {
                 return TokenType::CHAR;
             }
-            else if (std::isdigit(token[0]) ||
-                     (token[0] == '-' && token.size() > 1 && std::isdigit(token[1])))
+            else if ((charClass(token[0]) & CHAR_DIGIT) ||
+                     (token[0] == '-' && token.size() > 1 && (charClass(token[1]) & CHAR_DIGIT)))
             {
                 return TokenType::NUMBER;
             }
-            else if (token.find('\n') != std::string::npos)
+            else if (token.find('\n') != std::string_view::npos)
             {
                 return TokenType::NEWLINE;
             }
-            else if (token.find('\t') != std::string::npos)
+            else if (token.find('\t') != std::string_view::npos)
             {
                 return TokenType::INDENTATION;
             }
-            else if (std::isspace(token[0]))
+            else if (isWhitespace(token[0]))
             {
                 return TokenType::WHITESPACE;
             }
@@ -4,26 +4,29 @@
  *
  * 機能:
  * - トークンタイプの定義
- * - トークン構造体の実装
- * - 演算子リストと判定関数
- * - 文字種別判定関数
+ * - トークン構造体の実装（16バイトに詰めた表現）
+ * - 演算子仕様と判定関数
+ * - 演算子仕様からコンパイル時に生成する文字種別テーブル
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_5
  */
 #ifndef SIGN_COMMON_LEXER_TOKEN_H
 #define SIGN_COMMON_LEXER_TOKEN_H
 
+#include "common/lexer/symbol_table.h"
+#include <array>
+#include <cstdint>
 #include <string>
-#include <unordered_set>
+#include <string_view>
 
 namespace sign
 {
     namespace common
     {
 
-        // トークンの種類を表す列挙型
-        enum class TokenType
+        // トークンの種類を表す列挙型（トークン内では4ビットに詰めて持つ）
+        enum class TokenType : std::uint8_t
         {
             IDENTIFIER,    // 識別子
             NUMBER,        // 数値リテラル
@@ -41,25 +44,270 @@ namespace sign
             UNKNOWN        // 不明なトークン
         };
 
-        // トークン情報を格納する構造体
+        // トークン情報を格納する構造体（64ビット環境で16バイト）
+        // 値はコンパイル中ずっと生存するバッファへのビューで、先頭位置と、
+        // 長さ（24ビット）・種類（4ビット）・後置演算子の有無（1ビット）・前置演算子部分の長さ（3ビット）を詰めた32ビットで表す
+        // プリプロセッサが生成したトークン（!_0 など）の値は、合成トークンの文字列表に置く
+        // （文字列表は truncateSynthesized で戻すまで保持する。同じ値は共有するため、増えるのは異なる値の数だけ）
         struct Token
         {
-            std::string value; // トークンの値
-            TokenType type;    // トークンの種類
+            static constexpr size_t MAX_LENGTH = (size_t(1) << 24) - 1; // 値の最大長
 
-            // コンストラクタ
-            Token(const std::string &val, TokenType t) : value(val), type(t) {}
+        private:
+            const char *text;     // 値の先頭
+            std::uint32_t packed; // 長さ・種類・前置/後置演算子部分の長さ
+
+        public:
+            SymbolId symbol = INVALID_SYMBOL; // 識別子部分のID（IDENTIFIERのみ）
+
+            // コンストラクタ（ソースバッファまたは文字列リテラルを参照）
+            Token(std::string_view val, TokenType t)
+                : text(val.data()), packed(static_cast<std::uint32_t>(val.size()) | (static_cast<std::uint32_t>(t) << TYPE_SHIFT))
+            {
+                if (val.size() > MAX_LENGTH)
+                {
+                    throwTooLong(val.size());
+                }
+            }
+            Token(const char *val, TokenType t) : Token(std::string_view(val), t) {}
+
+            // 一時文字列を参照するとビューが無効になるため禁止
+            Token(std::string &&val, TokenType t) = delete;
+
+            /**
+             * 合成トークンを生成する
+             * 値は合成トークンの文字列表にコピーし、同じ値は共有する
+             *
+             * @param val トークンの値
+             * @param t トークンの種類
+             * @param symbol 識別子部分のID
+             * @return 合成トークン
+             */
+            static Token synthesize(std::string_view val, TokenType t, SymbolId symbol = INVALID_SYMBOL);
+
+            // 合成トークンの文字列表に登録済みの値の数（truncateSynthesized に渡す位置）
+            static size_t synthesizedCount();
+
+            /**
+             * synthesizedCount() が mark だった時点より後に登録した合成トークンの値を破棄する
+             * 前提は SymbolTable::truncate と同じ（破棄した値を参照するトークンが残っていないこと）
+             *
+             * @param mark 残す値の数
+             */
+            static void truncateSynthesized(size_t mark);
+
+            /**
+             * トークンの一部を参照する新しいトークンを生成する
+             *
+             * @param pos 開始位置
+             * @param count 文字数
+             * @param t 新しいトークンの種類
+             * @return 部分トークン
+             */
+            Token slice(size_t pos, size_t count, TokenType t) const;
+
+            // トークンの値
+            std::string_view value() const { return std::string_view(text, packed & LENGTH_MASK); }
+
+            // トークンの種類
+            TokenType type() const { return static_cast<TokenType>((packed >> TYPE_SHIFT) & TYPE_MASK); }
+
+            // 前置演算子部分の長さ（IDENTIFIERのみ）
+            size_t prefixLength() const
+            {
+                const size_t stored = packed >> PREFIX_SHIFT;
+                return stored < PREFIX_SATURATED ? stored : countPrefixLength();
+            }
+
+            // 後置演算子部分の長さ（IDENTIFIERのみ、0か1）
+            size_t postfixLength() const { return (packed >> POSTFIX_SHIFT) & 1; }
+
+            /**
+             * 字句解析時に分割した前置演算子部分と後置演算子部分の長さを設定する
+             *
+             * @param prefix 前置演算子部分の長さ
+             * @param postfix 後置演算子部分の長さ（0か1）
+             */
+            void setAffixLengths(size_t prefix, size_t postfix)
+            {
+                const size_t stored = prefix < PREFIX_SATURATED ? prefix : PREFIX_SATURATED;
+                packed = (packed & (LENGTH_MASK | (TYPE_MASK << TYPE_SHIFT))) |
+                         (static_cast<std::uint32_t>(postfix != 0) << POSTFIX_SHIFT) |
+                         (static_cast<std::uint32_t>(stored) << PREFIX_SHIFT);
+            }
+
+            // 字句解析時に分割した前置演算子・識別子・後置演算子の各部分
+            std::string_view prefix() const { return value().substr(0, prefixLength()); }
+            std::string_view identifier() const { return value().substr(prefixLength(), value().size() - prefixLength() - postfixLength()); }
+            std::string_view postfix() const { return value().substr(value().size() - postfixLength()); }
+
+        private:
+            static constexpr std::uint32_t LENGTH_MASK = static_cast<std::uint32_t>(MAX_LENGTH);
+            static constexpr unsigned TYPE_SHIFT = 24;
+            static constexpr std::uint32_t TYPE_MASK = 0xF;
+            static constexpr unsigned POSTFIX_SHIFT = 28;
+            static constexpr unsigned PREFIX_SHIFT = 29;
+            // 前置演算子部分がこの長さ以上なら、値の先頭から数え直す
+            static constexpr size_t PREFIX_SATURATED = 7;
+
+            // 値の先頭から前置演算子部分の長さを数える（長い前置演算子の場合のみ）
+            size_t countPrefixLength() const;
+
+            [[noreturn]] static void throwTooLong(size_t length);
         };
 
-        // 演算子リスト
-        extern const std::unordered_set<std::string> INFIX_OPERATORS;
-        extern const std::unordered_set<std::string> PREFIX_OPERATORS;
-        extern const std::unordered_set<std::string> POSTFIX_OPERATORS;
+        static_assert(static_cast<std::uint32_t>(TokenType::UNKNOWN) < 16, "TokenType は4ビットに収まる必要があります");
+        static_assert(sizeof(void *) != 8 || sizeof(Token) == 16, "64ビット環境のトークンは16バイト");
+
+        // 演算子の種類（ビットフラグ）
+        enum OperatorFlag : std::uint8_t
+        {
+            OP_INFIX = 1 << 0,   // 中置演算子
+            OP_PREFIX = 1 << 1,  // 前置演算子
+            OP_POSTFIX = 1 << 2, // 後置演算子
+            OP_SEPARATE = 1 << 3 // 常に独立したトークンになる（カッコと区切り文字）
+        };
+
+        // 演算子仕様の1項目
+        struct OperatorSpec
+        {
+            std::string_view symbol; // 演算子の文字列
+            std::uint8_t flags;      // OperatorFlagの組み合わせ
+            TokenType type;          // 独立したトークンになる場合のトークン種類
+        };
+
+        // 演算子仕様（文字種別テーブルと演算子判定はすべてここから生成する）
+        inline constexpr OperatorSpec OPERATOR_SPEC[] = {
+            {":", OP_INFIX | OP_SEPARATE, TokenType::DEFINE},
+            {"?", OP_INFIX | OP_SEPARATE, TokenType::LAMBDA},
+            {",", OP_INFIX | OP_SEPARATE, TokenType::COMMA},
+            {" ", OP_INFIX, TokenType::OPERATOR},
+            {"~", OP_INFIX | OP_PREFIX | OP_POSTFIX, TokenType::OPERATOR},
+            {";", OP_INFIX, TokenType::OPERATOR},
+            {"|", OP_INFIX, TokenType::OPERATOR},
+            {"&", OP_INFIX, TokenType::OPERATOR},
+            {"<", OP_INFIX, TokenType::OPERATOR},
+            {"<=", OP_INFIX, TokenType::OPERATOR},
+            {"=", OP_INFIX, TokenType::OPERATOR},
+            {">=", OP_INFIX, TokenType::OPERATOR},
+            {">", OP_INFIX, TokenType::OPERATOR},
+            {"!=", OP_INFIX, TokenType::OPERATOR},
+            {"+", OP_INFIX, TokenType::OPERATOR},
+            {"-", OP_INFIX, TokenType::OPERATOR},
+            {"*", OP_INFIX, TokenType::OPERATOR},
+            {"/", OP_INFIX, TokenType::OPERATOR},
+            {"%", OP_INFIX, TokenType::OPERATOR},
+            {"^", OP_INFIX, TokenType::OPERATOR},
+            {"'", OP_INFIX, TokenType::OPERATOR},
+            {"@", OP_INFIX | OP_PREFIX, TokenType::OPERATOR},
+            {"#", OP_PREFIX, TokenType::OPERATOR},
+            {"!", OP_PREFIX | OP_POSTFIX, TokenType::OPERATOR},
+            {"$", OP_PREFIX, TokenType::OPERATOR},
+            {"[", OP_PREFIX | OP_SEPARATE, TokenType::BRACKET_OPEN},
+            {"{", OP_PREFIX | OP_SEPARATE, TokenType::BRACKET_OPEN},
+            {"(", OP_PREFIX | OP_SEPARATE, TokenType::BRACKET_OPEN},
+            {"]", OP_POSTFIX | OP_SEPARATE, TokenType::BRACKET_CLOSE},
+            {"}", OP_POSTFIX | OP_SEPARATE, TokenType::BRACKET_CLOSE},
+            {")", OP_POSTFIX | OP_SEPARATE, TokenType::BRACKET_CLOSE}};
+
+        // 文字種別（ビットフラグ、下位4ビットは1文字演算子のOperatorFlag）
+        enum CharClass : std::uint8_t
+        {
+            CHAR_INFIX = OP_INFIX,        // 1文字の中置演算子
+            CHAR_PREFIX = OP_PREFIX,      // 1文字の前置演算子
+            CHAR_POSTFIX = OP_POSTFIX,    // 1文字の後置演算子
+            CHAR_SEPARATE = OP_SEPARATE,  // カッコと区切り文字
+            CHAR_WHITESPACE = 1 << 4,     // 空白文字
+            CHAR_DIGIT = 1 << 5,          // 数字
+            CHAR_LITERAL_START = 1 << 6,  // リテラル開始文字（バッククォートとバックスラッシュ）
+            CHAR_OPERATOR_LEAD = 1 << 7   // 2文字演算子の先頭文字
+        };
+
+        // 演算子仕様から文字種別テーブルを生成する
+        constexpr std::array<std::uint8_t, 256> buildCharClassTable()
+        {
+            std::array<std::uint8_t, 256> table{};
+            for (const auto &spec : OPERATOR_SPEC)
+            {
+                const auto lead = static_cast<unsigned char>(spec.symbol[0]);
+                if (spec.symbol.size() == 1)
+                {
+                    table[lead] |= spec.flags;
+                }
+                else
+                {
+                    table[lead] |= CHAR_OPERATOR_LEAD;
+                }
+            }
+            for (unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r'})
+            {
+                table[c] |= CHAR_WHITESPACE;
+            }
+            for (unsigned char c = '0'; c <= '9'; ++c)
+            {
+                table[c] |= CHAR_DIGIT;
+            }
+            table[static_cast<unsigned char>('`')] |= CHAR_LITERAL_START;
+            table[static_cast<unsigned char>('\\')] |= CHAR_LITERAL_START;
+            return table;
+        }
+
+        // 独立したトークンになる文字のトークン種類テーブルを生成する
+        constexpr std::array<TokenType, 256> buildSeparateTypeTable()
+        {
+            std::array<TokenType, 256> table{};
+            for (auto &type : table)
+            {
+                type = TokenType::UNKNOWN;
+            }
+            for (const auto &spec : OPERATOR_SPEC)
+            {
+                if (spec.flags & OP_SEPARATE)
+                {
+                    table[static_cast<unsigned char>(spec.symbol[0])] = spec.type;
+                }
+            }
+            return table;
+        }
+
+        inline constexpr std::array<std::uint8_t, 256> CHAR_CLASS = buildCharClassTable();
+        inline constexpr std::array<TokenType, 256> SEPARATE_TYPE = buildSeparateTypeTable();
+
+        // 文字種別を返す
+        constexpr std::uint8_t charClass(char c)
+        {
+            return CHAR_CLASS[static_cast<unsigned char>(c)];
+        }
+
+        /**
+         * 演算子仕様から演算子の種類を判定する（ハッシュ検索なし）
+         *
+         * @param str 判定対象の文字列
+         * @return OperatorFlagの組み合わせ（演算子でなければ0）
+         */
+        constexpr std::uint8_t operatorFlags(std::string_view str)
+        {
+            if (str.size() == 1)
+            {
+                return charClass(str[0]) & (OP_INFIX | OP_PREFIX | OP_POSTFIX | OP_SEPARATE);
+            }
+            if (str.size() == 2 && (charClass(str[0]) & CHAR_OPERATOR_LEAD))
+            {
+                for (const auto &spec : OPERATOR_SPEC)
+                {
+                    if (spec.symbol == str)
+                    {
+                        return spec.flags;
+                    }
+                }
+            }
+            return 0;
+        }
 
         // 演算子判定関数
-        bool isInfixOperator(const std::string &str);
-        bool isPrefixOperator(const std::string &str);
-        bool isPostfixOperator(const std::string &str);
+        bool isInfixOperator(std::string_view str);
+        bool isPrefixOperator(std::string_view str);
+        bool isPostfixOperator(std::string_view str);
 
         // 文字判定関数
         bool isDelimiter(char c);
@@ -67,7 +315,7 @@ namespace sign
         bool isWhitespace(char c);
 
         // トークン種類判定
-        TokenType determineTokenType(const std::string &token);
+        TokenType determineTokenType(std::string_view token);
 
     } // namespace common
 } // namespace sign
@@ -0,0 +1,99 @@
+// src/common/lexer/token_stream.cpp
+/**
+ * 索引付きのトークン列の実装
+ *
+ * ver_20261016_0
+ */
+
+#include "common/lexer/token_stream.h"
+
+namespace sign
+{
+    namespace common
+    {
+
+        TokenStream::TokenStream(std::vector<Token> tokens)
+            : items(std::move(tokens))
+        {
+            buildIndex();
+        }
+
+        void TokenStream::assign(const std::vector<Token> &tokens)
+        {
+            items.assign(tokens.begin(), tokens.end());
+            buildIndex();
+        }
+
+        std::vector<Token> TokenStream::release()
+        {
+            std::vector<Token> result = std::move(items);
+            items.clear();
+            kinds.clear();
+            links.clear();
+            return result;
+        }
+
+        void TokenStream::buildIndex()
+        {
+            const size_t count = items.size();
+            kinds.resize(count);
+            links.assign(count, NO_LINK);
+
+            // 閉じていない開き括弧と、深さごとの右辺が終わっていない定義演算子
+            // （ブロックごとに確保し直さないよう、スレッドごとに使い回す）
+            thread_local std::vector<std::uint32_t> openBrackets;
+            thread_local std::vector<std::uint32_t> openDefinitions;
+            openBrackets.clear();
+            openDefinitions.clear();
+
+            // 深さ depth で右辺が終わっていない定義演算子を、位置 end で終わらせる
+            const auto closeDefinition = [this](size_t depth, std::uint32_t end)
+            {
+                if (depth < openDefinitions.size() && openDefinitions[depth] != NO_LINK)
+                {
+                    links[openDefinitions[depth]] = end;
+                    openDefinitions[depth] = NO_LINK;
+                }
+            };
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto pos = static_cast<std::uint32_t>(i);
+                const TokenType type = items[i].type();
+                kinds[i] = type;
+
+                switch (type)
+                {
+                case TokenType::BRACKET_OPEN:
+                    openBrackets.push_back(pos);
+                    break;
+                case TokenType::BRACKET_CLOSE:
+                    // 括弧の内側（対応のない閉じ括弧なら深さ0）の定義の右辺はここで終わる
+                    closeDefinition(openBrackets.size(), pos);
+                    if (!openBrackets.empty())
+                    {
+                        links[openBrackets.back()] = pos;
+                        links[i] = openBrackets.back();
+                        openBrackets.pop_back();
+                    }
+                    break;
+                case TokenType::DEFINE:
+                {
+                    // 同じ深さの直前の定義の右辺はここで終わり、この定義の右辺が始まる
+                    const size_t depth = openBrackets.size();
+                    closeDefinition(depth, pos);
+                    if (openDefinitions.size() <= depth)
+                    {
+                        openDefinitions.resize(depth + 1, NO_LINK);
+                    }
+                    openDefinitions[depth] = pos;
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+        }
+
+    } // namespace common
+} // namespace sign
@@ -0,0 +1,133 @@
+// src/common/lexer/token_stream.h
+/**
+ * 索引付きのトークン列を提供するモジュール
+ *
+ * 機能:
+ * - トークンの種類だけを並べた配列（1トークン1バイト、memchr などのベクトル化された検索で走査できる）
+ * - 開き括弧と閉じ括弧を相互に引ける対応表
+ * - 定義演算子 : から右辺の終わりの位置を引ける表
+ *
+ * 索引はトークン列の構築時（字句解析の直後など）に、括弧のスタックで1回走査して計算する。
+ * 括弧の種類は区別せず、開き括弧と閉じ括弧を入れ子の順に対応させる。
+ *
+ * ver_20261016_0
+ */
+#ifndef SIGN_COMMON_LEXER_TOKEN_STREAM_H
+#define SIGN_COMMON_LEXER_TOKEN_STREAM_H
+
+#include "common/lexer/token.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace sign
+{
+    namespace common
+    {
+
+        // 種類の配列と括弧の対応表を持つトークン列
+        class TokenStream
+        {
+        public:
+            static constexpr size_t npos = static_cast<size_t>(-1);
+
+            TokenStream() = default;
+
+            /**
+             * トークン列を受け取り、索引を構築する
+             *
+             * @param tokens トークン列
+             */
+            explicit TokenStream(std::vector<Token> tokens);
+
+            /**
+             * トークン列を写して索引を構築し直す
+             * 確保済みの領域を再利用するため、多数のブロックを順に調べる場合に1つのトークン列を使い回せる
+             *
+             * @param tokens トークン列
+             */
+            void assign(const std::vector<Token> &tokens);
+
+            /**
+             * トークンを置き換える
+             * 括弧の対応と定義の右辺は変わらないものとするため、括弧と定義演算子は置き換えられない
+             *
+             * @param pos 位置
+             * @param token 置き換え後のトークン（括弧と定義演算子以外）
+             */
+            void replace(size_t pos, const Token &token)
+            {
+                items[pos] = token;
+                kinds[pos] = token.type();
+            }
+
+            size_t size() const { return items.size(); }
+            bool empty() const { return items.empty(); }
+
+            const Token &operator[](size_t pos) const { return items[pos]; }
+
+            // 位置 pos のトークンの種類（種類の配列から読む）
+            TokenType type(size_t pos) const { return kinds[pos]; }
+
+            // トークン列
+            const std::vector<Token> &tokens() const { return items; }
+
+            // トークン列を取り出す（索引は破棄する）
+            std::vector<Token> release();
+
+            /**
+             * [pos, end) の範囲で最初の種類 type のトークンの位置を返す
+             *
+             * @param type 種類
+             * @param pos 検索開始位置
+             * @param end 検索終了位置
+             * @return トークンの位置（なければend）
+             */
+            size_t find(TokenType type, size_t pos, size_t end) const
+            {
+                if (pos >= end)
+                {
+                    return end;
+                }
+                const void *hit = std::memchr(kinds.data() + pos, static_cast<int>(type), end - pos);
+                return hit != nullptr ? static_cast<size_t>(static_cast<const TokenType *>(hit) - kinds.data()) : end;
+            }
+
+            /**
+             * 括弧に対応する括弧の位置を返す
+             *
+             * @param pos 括弧の位置
+             * @return 対応する括弧の位置（対応する括弧がなければnpos）
+             */
+            size_t match(size_t pos) const { return toPosition(links[pos]); }
+
+            /**
+             * 定義演算子 : の右辺の終わりの位置を返す
+             * 右辺は、同じ深さの次の定義演算子か、対応する開き括弧が右辺より前にある閉じ括弧の直前まで
+             *
+             * @param define 定義演算子の位置
+             * @return 右辺を終わらせる定義演算子か閉じ括弧の位置（ブロック末尾まで続く場合はsize()）
+             */
+            size_t definitionEnd(size_t define) const
+            {
+                const size_t end = toPosition(links[define]);
+                return end == npos ? items.size() : end;
+            }
+
+        private:
+            static constexpr std::uint32_t NO_LINK = UINT32_MAX;
+
+            static size_t toPosition(std::uint32_t link) { return link == NO_LINK ? npos : link; }
+
+            // 種類の配列と対応表を構築する
+            void buildIndex();
+
+            std::vector<Token> items;         // トークン
+            std::vector<TokenType> kinds;     // トークンの種類（items と同じ順）
+            std::vector<std::uint32_t> links; // 括弧は対応する括弧、定義演算子は右辺の終わりの位置
+        };
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_LEXER_TOKEN_STREAM_H
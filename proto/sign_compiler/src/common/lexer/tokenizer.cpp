@@ -1,13 +1,15 @@
 // src/common/lexer/tokenizer.cpp
 /**
  * Sign言語のソースコードをトークン化する実装
- * シンプルな区切りルールに基づく設計
+ * 演算子仕様から生成した文字種別テーブルによる1パスの字句解析
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_7
  */
 
 #include "common/lexer/tokenizer.h"
+#include "common/lexer/structural_index.h"
+#include <algorithm>
 #include <sstream>
 
 namespace sign
@@ -21,188 +23,229 @@ namespace sign
             std::stringstream ss;
             for (const auto &token : tokens)
             {
-                ss << token.value;
+                ss << token.value();
             }
             return ss.str();
         }
 
-        std::vector<Token> tokenizeBlock(const std::string &block)
+        // トークン配列を空白区切りで追加
+        void appendTokens(std::string &output, const std::vector<Token> &tokens)
         {
-            if (block.empty())
+            size_t length = output.size() + tokens.size();
+            for (const auto &token : tokens)
             {
-                return {};
+                length += token.value().size();
             }
+            output.reserve(length);
 
-            std::vector<Token> tokens;
-            std::string currentToken;
-            bool inString = false;      // 文字列リテラル内かどうか
-            bool inCharLiteral = false; // 特殊文字リテラル内かどうか
-            bool inIndent = false;      // インデントパターン内かどうか
-
-            // 現在のトークンを追加してリセットする関数
-            auto addCurrentToken = [&]()
+            for (size_t i = 0; i < tokens.size(); ++i)
             {
-                if (!currentToken.empty())
+                if (i > 0)
                 {
-                    TokenType tokenType = determineTokenType(currentToken);
-                    tokens.push_back(Token(currentToken, tokenType));
-                    currentToken.clear();
-                }
-            };
-
-            // 文字ごとに処理
-            for (size_t i = 0; i < block.size(); ++i)
-            {
-                char c = block[i];
-
-                // 文字列リテラル内の処理
-                if (inString)
-                {
-                    currentToken += c;
-                    if (c == '`')
-                    {
-                        addCurrentToken();
-                        inString = false;
-                    }
-                    continue;
+                    output += ' ';
                 }
+                output.append(tokens[i].value());
+            }
+        }
 
-                // 特殊文字リテラル内の処理
-                if (inCharLiteral)
-                {
-                    currentToken += c;
-                    addCurrentToken();
-                    inCharLiteral = false;
-                    continue;
-                }
+        // 字句解析の本体
+        // nextStructural(i) は位置i以降で最初の構造文字の位置（なければブロック長）を返す
+        template <typename NextStructural>
+        static std::vector<Token> scanBlock(std::string_view block, NextStructural nextStructural)
+        {
+            SymbolTable &symbols = globalSymbols();
+            std::vector<Token> tokens;
+            const size_t length = block.size();
+            size_t i = 0;
 
-                // インデントパターン内の処理
-                if (inIndent)
-                {
-                    if (c == '\t')
-                    {
-                        currentToken += c;
-                    }
-                    else
-                    {
-                        addCurrentToken();
-                        inIndent = false;
-                        --i; // 現在の文字を再処理
-                    }
-                    continue;
-                }
+            // 文字種別テーブルで状態遷移しながら1パスでトークンを切り出す
+            while (i < length)
+            {
+                const char c = block[i];
+                const std::uint8_t cls = charClass(c);
+                const size_t start = i;
 
-                // 新しいトークンの開始
                 if (c == '`')
                 {
-                    // 文字列リテラル開始
-                    addCurrentToken();
-                    currentToken = c;
-                    inString = true;
+                    // 文字列リテラル（閉じバッククォートまで、なければブロック末尾まで）
+                    size_t end = block.find('`', i + 1);
+                    i = (end == std::string_view::npos) ? length : end + 1;
+                    tokens.push_back(Token(block.substr(start, i - start), TokenType::STRING));
                 }
                 else if (c == '\\')
                 {
-                    // 特殊文字リテラル
-                    addCurrentToken();
-                    currentToken = c;
-                    inCharLiteral = true;
+                    // 特殊文字リテラル（バックスラッシュと次の1文字）
+                    i = std::min(i + 2, length);
+                    tokens.push_back(Token(block.substr(start, i - start), TokenType::CHAR));
                 }
                 else if (c == '\n')
                 {
-                    // 改行 - インデントパターン開始の可能性
-                    addCurrentToken();
-                    currentToken = c;
-                    inIndent = true; // 次のタブ文字があればインデント
+                    // 改行とそれに続くインデント（タブ）
+                    ++i;
+                    while (i < length && block[i] == '\t')
+                    {
+                        ++i;
+                    }
+                    tokens.push_back(Token(block.substr(start, i - start), TokenType::NEWLINE));
                 }
-                else if (isWhitespace(c))
+                else if (cls & CHAR_WHITESPACE)
                 {
                     // 空白はトークン区切り
-                    addCurrentToken();
-                }
-                else if (isBracket(c))
-                {
-                    // カッコは独立したトークン
-                    addCurrentToken();
-                    tokens.push_back(Token(std::string(1, c), determineTokenType(std::string(1, c))));
+                    ++i;
                 }
-                else if (isDelimiter(c))
+                else if (cls & CHAR_SEPARATE)
                 {
-                    // 特定の区切り文字も独立したトークン
-                    addCurrentToken();
-                    tokens.push_back(Token(std::string(1, c), determineTokenType(std::string(1, c))));
+                    // カッコと特定の区切り文字は独立したトークン
+                    ++i;
+                    tokens.push_back(Token(block.substr(start, 1), SEPARATE_TYPE[static_cast<unsigned char>(c)]));
                 }
                 else
                 {
-                    // 通常の文字の場合
-                    currentToken += c;
+                    // 通常の文字列（先頭の前置演算子部分を数えながら区切り文字まで進む）
+                    size_t prefixLength = 0;
+                    while (i < length && (charClass(block[i]) & CHAR_PREFIX) && !(charClass(block[i]) & CHAR_SEPARATE))
+                    {
+                        ++prefixLength;
+                        ++i;
+                    }
+                    if (i < length && !isStructural(block[i]))
+                    {
+                        i = nextStructural(i);
+                    }
+
+                    std::string_view text = block.substr(start, i - start);
+                    if (text.size() <= 2 && operatorFlags(text) != 0)
+                    {
+                        tokens.push_back(Token(text, TokenType::OPERATOR));
+                    }
+                    else if ((cls & CHAR_DIGIT) ||
+                             (c == '-' && text.size() > 1 && (charClass(text[1]) & CHAR_DIGIT)))
+                    {
+                        tokens.push_back(Token(text, TokenType::NUMBER));
+                    }
+                    else
+                    {
+                        // 識別子は字句解析時に一度だけ演算子部分を分割してインターンする
+                        Token token(text, TokenType::IDENTIFIER);
+                        token.setAffixLengths(prefixLength, (prefixLength < text.size() && (charClass(text.back()) & CHAR_POSTFIX)) ? 1 : 0);
+                        token.symbol = symbols.intern(token.identifier());
+                        tokens.push_back(token);
+                    }
                 }
             }
 
-            // 最後のトークンを追加
-            addCurrentToken();
-
             return tokens;
         }
 
-        std::string extractPrefixOperator(const std::string &token)
+        std::vector<Token> tokenizeBlock(std::string_view block)
         {
-            if (token.empty())
-                return "";
+            if (block.empty())
+            {
+                return {};
+            }
 
-            // 最長の前置演算子を検索
-            std::string prefix = "";
-            for (size_t i = 1; i <= token.length(); ++i)
+            return scanBlock(block, [block](size_t i)
+                             {
+                                 while (i < block.size() && !isStructural(block[i]))
+                                 {
+                                     ++i;
+                                 }
+                                 return i; });
+        }
+
+        std::vector<Token> tokenizeBlock(std::string_view block, const StructuralIndex &index, size_t offset)
+        {
+            if (block.empty())
             {
-                std::string candidate = token.substr(0, i);
+                return {};
+            }
 
-                // 単一文字の演算子チェック
-                if (i == 1 && isPrefixOperator(candidate))
-                {
-                    prefix = candidate;
-                }
-                // 複数文字の演算子（例：$@）のチェック
-                else if (i > 1 && isPrefixOperator(token.substr(i - 1, 1)))
-                {
-                    prefix = token.substr(0, i);
-                }
-                else
-                {
-                    // 演算子でない文字が見つかったら終了
-                    break;
-                }
+            // 索引はテキスト全体の位置なので、ブロック内の位置に変換する
+            return scanBlock(block, [&index, offset, &block](size_t i)
+                             {
+                                 size_t next = index.nextStructural(offset + i);
+                                 return (next == StructuralIndex::npos) ? block.size() : std::min(next - offset, block.size()); });
+        }
+
+        TokenStream tokenizeStream(std::string_view block)
+        {
+            return TokenStream(tokenizeBlock(block));
+        }
+
+        TokenStream tokenizeStream(std::string_view block, const StructuralIndex &index, size_t offset)
+        {
+            return TokenStream(tokenizeBlock(block, index, offset));
+        }
+
+        std::string_view extractPrefixOperator(std::string_view token)
+        {
+            // 最長の前置演算子を検索（先頭から連続する前置演算子文字）
+            size_t length = 0;
+            while (length < token.length() && isPrefixOperator(token.substr(length, 1)))
+            {
+                ++length;
             }
 
-            return prefix;
+            return token.substr(0, length);
         }
 
-        std::string extractPostfixOperator(const std::string &token)
+        std::string_view extractPostfixOperator(std::string_view token)
         {
             if (token.empty())
-                return "";
+                return {};
 
             // 後置演算子は通常単一文字なので、最後の文字をチェック
-            if (isPostfixOperator(token.substr(token.length() - 1)))
+            std::string_view last = token.substr(token.length() - 1);
+            if (isPostfixOperator(last))
             {
-                return token.substr(token.length() - 1);
+                return last;
             }
 
-            return "";
+            return {};
         }
 
-        std::string extractIdentifier(const std::string &token)
+        std::string_view extractIdentifier(std::string_view token)
         {
             if (token.empty())
-                return "";
+                return {};
 
-            std::string prefix = extractPrefixOperator(token);
+            std::string_view prefix = extractPrefixOperator(token);
 
             // 前置演算子を除いた残りの部分から識別子と後置演算子を分離
-            std::string remainder = token.substr(prefix.length());
-            std::string postfix = extractPostfixOperator(remainder);
+            std::string_view remainder = token.substr(prefix.length());
+            std::string_view postfix = extractPostfixOperator(remainder);
 
             // 識別子部分を抽出
             return remainder.substr(0, remainder.length() - postfix.length());
         }
 
+        Token renameIdentifier(const Token &token, SymbolId replacement)
+        {
+            if (token.prefixLength() == 0 && token.postfixLength() == 0)
+            {
+                Token renamed(globalSymbols().name(replacement), token.type());
+                renamed.symbol = replacement;
+                return renamed;
+            }
+
+            // 前置演算子 + 置換後の識別子 + 後置演算子 を一度の確保で構築
+            std::string_view name = globalSymbols().name(replacement);
+            std::string value;
+            value.reserve(token.prefixLength() + name.length() + token.postfixLength());
+            value.append(token.prefix()).append(name).append(token.postfix());
+
+            Token renamed = Token::synthesize(value, token.type(), replacement);
+            renamed.setAffixLengths(token.prefixLength(), token.postfixLength());
+            return renamed;
+        }
+
+        Token identifierToken(SymbolId symbol)
+        {
+            // シンボルテーブルの文字列はプログラム終了まで有効
+            Token token(globalSymbols().name(symbol), TokenType::IDENTIFIER);
+            token.symbol = symbol;
+            return token;
+        }
+
     } // namespace common
 } // namespace sign
\ No newline at end of file
@@ -6,16 +6,19 @@
  * - ソースコードのトークン化
  * - 文字列リテラルの適切な処理
  * - トークン列の操作と変換
+ * - 括弧の対応表付きのトークン列（TokenStream）へのトークン化
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_4
  */
 
 #ifndef SIGN_COMMON_LEXER_TOKENIZER_H
 #define SIGN_COMMON_LEXER_TOKENIZER_H
 
 #include "common/lexer/token.h"
+#include "common/lexer/token_stream.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace sign
@@ -23,13 +26,52 @@ namespace sign
     namespace common
     {
 
+        class StructuralIndex;
+
         /**
          * ソースコードブロックをトークン化する
+         * 各トークンはblockへのビューなので、blockはトークンより長く生存する必要がある
          *
          * @param block トークン化するコードブロック
          * @return トークン配列
          */
-        std::vector<Token> tokenizeBlock(const std::string &block);
+        std::vector<Token> tokenizeBlock(std::string_view block);
+
+        // 一時文字列のトークン化はビューが無効になるため禁止
+        std::vector<Token> tokenizeBlock(std::string &&block) = delete;
+
+        /**
+         * 構造文字索引を利用してソースコードブロックをトークン化する
+         * 識別子などの通常の文字列は1文字ずつ走査せず、索引で次の区切りまで進む
+         *
+         * @param block トークン化するコードブロック（索引化したテキストの一部）
+         * @param index ブロックを含むテキスト全体の構造文字索引
+         * @param offset テキスト内のブロックの先頭位置
+         * @return トークン配列
+         */
+        std::vector<Token> tokenizeBlock(std::string_view block, const StructuralIndex &index, size_t offset);
+
+        /**
+         * ソースコードブロックを索引付きのトークン列にトークン化する
+         * 括弧の対応と定義の右辺の終わりは、トークンの切り出しの直後に1回走査して求める
+         *
+         * @param block トークン化するコードブロック
+         * @return 索引付きのトークン列
+         */
+        TokenStream tokenizeStream(std::string_view block);
+
+        // 一時文字列のトークン化はビューが無効になるため禁止
+        TokenStream tokenizeStream(std::string &&block) = delete;
+
+        /**
+         * 構造文字索引を利用してソースコードブロックを索引付きのトークン列にトークン化する
+         *
+         * @param block トークン化するコードブロック（索引化したテキストの一部）
+         * @param index ブロックを含むテキスト全体の構造文字索引
+         * @param offset テキスト内のブロックの先頭位置
+         * @return 索引付きのトークン列
+         */
+        TokenStream tokenizeStream(std::string_view block, const StructuralIndex &index, size_t offset);
 
         /**
          * トークン配列を文字列に変換
@@ -39,30 +81,57 @@ namespace sign
          */
         std::string tokensToString(const std::vector<Token> &tokens);
 
+        /**
+         * トークン配列を空白区切りで文字列の末尾に追加する
+         * プリプロセス結果の出力形式（トークン間に空白1つ）
+         *
+         * @param output 追加先の文字列
+         * @param tokens トークン配列
+         */
+        void appendTokens(std::string &output, const std::vector<Token> &tokens);
+
         /**
          * トークンから前置演算子部分を抽出する
          *
          * @param token 対象トークン
-         * @return 前置演算子部分の文字列（なければ空文字列）
+         * @return 前置演算子部分のビュー（なければ空）
          */
-        std::string extractPrefixOperator(const std::string &token);
+        std::string_view extractPrefixOperator(std::string_view token);
 
         /**
          * トークンから後置演算子部分を抽出する
          *
          * @param token 対象トークン
-         * @return 後置演算子部分の文字列（なければ空文字列）
+         * @return 後置演算子部分のビュー（なければ空）
          */
-        std::string extractPostfixOperator(const std::string &token);
+        std::string_view extractPostfixOperator(std::string_view token);
 
         /**
          * トークンから識別子部分を抽出する
          * 前置演算子と後置演算子を除いた部分を返す
          *
          * @param token 対象トークン
-         * @return 識別子部分の文字列
+         * @return 識別子部分のビュー
+         */
+        std::string_view extractIdentifier(std::string_view token);
+
+        /**
+         * 識別子トークンの識別子部分を置き換えたトークンを生成する
+         * 前置/後置演算子は保持し、演算子がなければシンボルテーブルの文字列を参照する
+         *
+         * @param token 置換元の識別子トークン
+         * @param replacement 置換後の識別子のID
+         * @return 置換後のトークン
+         */
+        Token renameIdentifier(const Token &token, SymbolId replacement);
+
+        /**
+         * 識別子のIDから演算子を持たない識別子トークンを生成する
+         *
+         * @param symbol 識別子のID
+         * @return シンボルテーブルの文字列を参照する識別子トークン
          */
-        std::string extractIdentifier(const std::string &token);
+        Token identifierToken(SymbolId symbol);
 
     } // namespace common
 } // namespace sign
@@ -3,17 +3,35 @@
  * Sign言語のソースコードからコードブロックを抽出する実装
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_0
  */
 
 #include "common/parser/block_extractor.h"
-#include <sstream>
+#include "common/lexer/structural_index.h"
 
 namespace sign
 {
     namespace common
     {
 
+        // 索引の改行位置から行ごとのビューに分割する（std::getlineと同じ分割規則）
+        static std::vector<std::string_view> splitLineViews(std::string_view code, const StructuralIndex &index)
+        {
+            std::vector<std::string_view> lines;
+            size_t lineStart = 0;
+            while (lineStart < code.size())
+            {
+                size_t lineEnd = index.nextNewline(lineStart);
+                if (lineEnd == StructuralIndex::npos)
+                {
+                    lineEnd = code.size();
+                }
+                lines.push_back(code.substr(lineStart, lineEnd - lineStart));
+                lineStart = lineEnd + 1;
+            }
+            return lines;
+        }
+
         std::vector<std::string> extractCodeBlocks(const std::string &sourceCode)
         {
             if (sourceCode.empty())
@@ -21,32 +39,44 @@ namespace sign
                 return {};
             }
 
-            // 行ごとに分割
-            std::vector<std::string> lines;
-            std::stringstream ss(sourceCode);
-            std::string line;
+            return extractCodeBlocks(sourceCode, StructuralIndex(sourceCode));
+        }
 
-            while (std::getline(ss, line))
-            {
-                lines.push_back(line);
-            }
+        std::vector<std::string> extractCodeBlocks(std::string_view sourceCode, const StructuralIndex &index)
+        {
+            // 行ごとに分割
+            std::vector<std::string_view> lines = splitLineViews(sourceCode, index);
 
             // 抽出されたブロックを格納する配列
             std::vector<std::string> blocks;
 
             // 現在処理中のブロック
-            std::vector<std::string> currentBlock;
+            std::vector<std::string_view> currentBlock;
 
             // 現在の行がブロックの先頭かどうかを追跡
             bool isNewBlock = true;
 
+            // 現在のブロックを結合して保存する関数
+            auto flushBlock = [&]()
+            {
+                std::string blockContent;
+                for (size_t j = 0; j < currentBlock.size(); ++j)
+                {
+                    if (j > 0)
+                        blockContent += "\n";
+                    blockContent += currentBlock[j];
+                }
+                blocks.push_back(std::move(blockContent));
+                currentBlock.clear();
+            };
+
             // 各行を処理
             for (size_t i = 0; i < lines.size(); ++i)
             {
                 const auto &line = lines[i];
 
                 // 空行はスキップ
-                if (line.empty() || line.find_first_not_of(" \t") == std::string::npos)
+                if (line.empty() || line.find_first_not_of(" \t") == std::string_view::npos)
                 {
                     // ただし、ブロックの途中にある空行は保持
                     if (!currentBlock.empty())
@@ -64,15 +94,7 @@ namespace sign
                     // 前のブロックがあれば保存
                     if (!currentBlock.empty())
                     {
-                        std::string blockContent;
-                        for (size_t j = 0; j < currentBlock.size(); ++j)
-                        {
-                            if (j > 0)
-                                blockContent += "\n";
-                            blockContent += currentBlock[j];
-                        }
-                        blocks.push_back(blockContent);
-                        currentBlock.clear();
+                        flushBlock();
                     }
 
                     // 新しいブロックの開始
@@ -86,11 +108,11 @@ namespace sign
                 }
 
                 // 次の行を先読みしてブロックの区切りを判断
-                const std::string *nextLine = (i + 1 < lines.size()) ? &lines[i + 1] : nullptr;
+                const std::string_view *nextLine = (i + 1 < lines.size()) ? &lines[i + 1] : nullptr;
 
-                if (!nextLine ||                                               // ファイルの終端
-                    nextLine->empty() ||                                       // 空行
-                    nextLine->find_first_not_of(" \t") == std::string::npos || // 空白のみの行
+                if (!nextLine ||                                                    // ファイルの終端
+                    nextLine->empty() ||                                            // 空行
+                    nextLine->find_first_not_of(" \t") == std::string_view::npos || // 空白のみの行
                     (nextLine->size() > 0 && nextLine->at(0) != '\t' && !startsWithTab))
                 { // インデントなしの新しい行
                     // 次の行が新しいブロックの開始
@@ -101,19 +123,39 @@ namespace sign
             // 最後のブロックがあれば追加
             if (!currentBlock.empty())
             {
-                std::string blockContent;
-                for (size_t j = 0; j < currentBlock.size(); ++j)
-                {
-                    if (j > 0)
-                        blockContent += "\n";
-                    blockContent += currentBlock[j];
-                }
-                blocks.push_back(blockContent);
+                flushBlock();
             }
 
             return blocks;
         }
 
+        std::vector<BlockSpan> extractCodeBlockSpans(std::string_view normalizedCode, const StructuralIndex &index)
+        {
+            // 正規化済みのコードには空白のみの行がないため、
+            // ブロックは「タブで始まらない行 + 続くタブで始まる行」の連続した範囲になる
+            std::vector<BlockSpan> spans;
+            size_t lineStart = 0;
+            while (lineStart < normalizedCode.size())
+            {
+                size_t lineEnd = index.nextNewline(lineStart);
+                if (lineEnd == StructuralIndex::npos)
+                {
+                    lineEnd = normalizedCode.size();
+                }
+
+                if (spans.empty() || normalizedCode[lineStart] != '\t')
+                {
+                    spans.push_back({lineStart, lineEnd - lineStart});
+                }
+                else
+                {
+                    spans.back().length = lineEnd - spans.back().offset;
+                }
+                lineStart = lineEnd + 1;
+            }
+            return spans;
+        }
+
         std::vector<std::string> processBlocks(const std::vector<std::string> &blocks, bool wrapWithBrackets)
         {
             std::vector<std::string> processedBlocks;
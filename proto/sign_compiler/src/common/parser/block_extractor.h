@@ -8,13 +8,14 @@
  * - 各ブロックを独立した処理単位として分離
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_0
  */
 
 #ifndef SIGN_COMMON_PARSER_BLOCK_EXTRACTOR_H
 #define SIGN_COMMON_PARSER_BLOCK_EXTRACTOR_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace sign
@@ -22,6 +23,8 @@ namespace sign
     namespace common
     {
 
+        class StructuralIndex;
+
         /**
          * ソースコードから処理のまとまり（コードブロック）を抽出する
          *
@@ -30,6 +33,33 @@ namespace sign
          */
         std::vector<std::string> extractCodeBlocks(const std::string &sourceCode);
 
+        /**
+         * 構造文字索引を利用してコードブロックを抽出する
+         *
+         * @param sourceCode 前処理済みのソースコード
+         * @param index sourceCodeの構造文字索引
+         * @return 抽出されたコードブロックの配列
+         */
+        std::vector<std::string> extractCodeBlocks(std::string_view sourceCode, const StructuralIndex &index);
+
+        // コードブロックの範囲（正規化済みコード内の位置）
+        struct BlockSpan
+        {
+            size_t offset; // 先頭位置
+            size_t length; // 長さ
+        };
+
+        /**
+         * 正規化済みのコードからコードブロックの範囲を抽出する
+         * 空白のみの行を含まないコードでは extractCodeBlocks と同じブロックになり、
+         * ブロックの文字列を複製せずにビューとして扱える
+         *
+         * @param normalizedCode normalizeSourceCode で正規化済みのコード
+         * @param index normalizedCodeの構造文字索引
+         * @return コードブロックの範囲の配列
+         */
+        std::vector<BlockSpan> extractCodeBlockSpans(std::string_view normalizedCode, const StructuralIndex &index);
+
         /**
          * 抽出されたコードブロックに対して前処理を行う
          * - ブロックを[]で囲む（オプション）
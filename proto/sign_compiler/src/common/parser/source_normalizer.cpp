@@ -0,0 +1,122 @@
+// src/common/parser/source_normalizer.cpp
+/**
+ * Sign言語のソースコードを1パスで正規化してブロックに分割する実装
+ *
+ * 入力の構造文字索引で行末と構造文字の位置を辿り、
+ * 構造文字の間は一括でコピー、カッコのみ文字単位で変換する
+ *
+ * ver_20261016_0
+ */
+
+#include "common/parser/source_normalizer.h"
+
+namespace sign
+{
+    namespace common
+    {
+
+        // 文字列リテラル外のカッコを角カッコに変換する
+        static char unifyBracket(char c)
+        {
+            if (c == '(' || c == '{')
+                return '[';
+            if (c == ')' || c == '}')
+                return ']';
+            return c;
+        }
+
+        static bool isLineSpace(char c)
+        {
+            return c == ' ' || c == '\t';
+        }
+
+        NormalizedSource normalizeSource(std::string_view sourceCode)
+        {
+            NormalizedSource result;
+            std::string &code = result.code;
+            code.reserve(sourceCode.size());
+
+            const StructuralIndex sourceIndex(sourceCode);
+            bool inLiteral = false;   // 文字列リテラル内かどうか（行をまたいで継続）
+            size_t literalStart = 0;  // 現在のリテラルの開始位置（出力内）
+
+            size_t lineStart = 0;
+            while (lineStart < sourceCode.size())
+            {
+                size_t lineEnd = sourceIndex.nextNewline(lineStart);
+                if (lineEnd == StructuralIndex::npos)
+                {
+                    lineEnd = sourceCode.size();
+                }
+                const size_t nextLine = lineEnd + 1;
+
+                // 空白のみの行とコメント行（行頭がバッククォート）はスキップ
+                size_t first = lineStart;
+                while (first < lineEnd && isLineSpace(sourceCode[first]))
+                {
+                    ++first;
+                }
+                if (first == lineEnd || sourceCode[first] == '`')
+                {
+                    lineStart = nextLine;
+                    continue;
+                }
+
+                // 行末の空白を除いた範囲
+                size_t last = lineEnd;
+                while (last > first && isLineSpace(sourceCode[last - 1]))
+                {
+                    --last;
+                }
+
+                // タブで始まらない行は新しいブロックの開始
+                if (!code.empty())
+                {
+                    code += '\n';
+                }
+                if (result.blocks.empty() || sourceCode[lineStart] != '\t')
+                {
+                    result.blocks.push_back({code.size(), 0});
+                }
+
+                // 構造文字の間は一括でコピーし、構造文字のみ個別に処理する
+                size_t copied = lineStart;
+                size_t pos = sourceIndex.nextStructural(lineStart);
+                while (pos < last)
+                {
+                    code.append(sourceCode.data() + copied, pos - copied);
+                    char c = sourceCode[pos];
+                    if (c == '`')
+                    {
+                        inLiteral = !inLiteral;
+                        literalStart = code.size();
+                    }
+                    else if (!inLiteral)
+                    {
+                        c = unifyBracket(c);
+                    }
+                    code += c;
+                    copied = pos + 1;
+                    pos = sourceIndex.nextStructural(copied);
+                }
+                code.append(sourceCode.data() + copied, last - copied);
+
+                result.blocks.back().length = code.size() - result.blocks.back().offset;
+                lineStart = nextLine;
+            }
+
+            // 閉じていないバッククォートは文字列リテラルとして保護しない
+            if (inLiteral)
+            {
+                for (size_t i = literalStart; i < code.size(); ++i)
+                {
+                    code[i] = unifyBracket(code[i]);
+                }
+            }
+
+            result.index = StructuralIndex(code);
+            return result;
+        }
+
+    } // namespace common
+} // namespace sign
@@ -0,0 +1,48 @@
+// src/common/parser/source_normalizer.h
+/**
+ * Sign言語のソースコードを1パスで正規化してブロックに分割するモジュール
+ *
+ * 機能:
+ * - コメント行・空白行の除去と行末空白の削除
+ * - 文字列リテラル外のカッコの角カッコへの統一
+ * - コードブロックの境界の検出
+ * 上記を入力の1回の走査で同時に行い、行の配列などの中間データを作らない
+ *
+ * ver_20261016_0
+ */
+
+#ifndef SIGN_COMMON_PARSER_SOURCE_NORMALIZER_H
+#define SIGN_COMMON_PARSER_SOURCE_NORMALIZER_H
+
+#include "common/lexer/structural_index.h"
+#include "common/parser/block_extractor.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sign
+{
+    namespace common
+    {
+
+        // 正規化済みのソースコードとそのブロック境界
+        struct NormalizedSource
+        {
+            std::string code;              // 正規化済みのコード
+            std::vector<BlockSpan> blocks; // code内のコードブロックの範囲
+            StructuralIndex index;         // codeの構造文字索引（トークン化で再利用）
+        };
+
+        /**
+         * ソースコードを1パスで正規化し、ブロック境界を出力する
+         * removeComments → unifyBrackets → extractCodeBlocks と同じ結果を線形時間で得る
+         *
+         * @param sourceCode 入力ソースコード
+         * @return 正規化済みのコードとブロック境界
+         */
+        NormalizedSource normalizeSource(std::string_view sourceCode);
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_PARSER_SOURCE_NORMALIZER_H
@@ -0,0 +1,36 @@
+// src/common/utils/allocation_counter.cpp
+/**
+ * メモリ確保量の計測の実装
+ *
+ * operator new の置き換えは allocation_hook.cpp にあり、実行ファイルにだけリンクする
+ *
+ * ver_20261016_1
+ */
+
+#include "common/utils/allocation_counter.h"
+
+namespace sign
+{
+    namespace common
+    {
+
+        std::uint64_t threadAllocatedBytes()
+        {
+#ifndef SIGN_NO_STATS
+            return detail::allocatedBytes;
+#else
+            return 0;
+#endif
+        }
+
+        bool allocationCountingEnabled()
+        {
+#ifndef SIGN_NO_STATS
+            return detail::hookLinked;
+#else
+            return false;
+#endif
+        }
+
+    } // namespace common
+} // namespace sign
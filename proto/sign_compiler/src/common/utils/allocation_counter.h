@@ -0,0 +1,43 @@
+// src/common/utils/allocation_counter.h
+/**
+ * メモリ確保量の計測
+ *
+ * 機能:
+ * - スレッドごとに確保したバイト数を数える（カウンタはスレッドローカルなので、並列処理中も競合しない）
+ * - 数えるのはグローバルな operator new の置き換え（allocation_hook.cpp）で、これは実行ファイル
+ *   （sign_compiler とベンチマーク）にだけリンクする。プリプロセッサ本体のソースには含めないため、
+ *   本体を組み込んだ他のプログラムの確保には手を加えない（その場合の確保量は常に0）
+ * - SIGN_NO_STATS を定義してビルドした場合は置き換えず、常に0を返す
+ *
+ * ver_20261016_1
+ */
+#ifndef SIGN_COMMON_UTILS_ALLOCATION_COUNTER_H
+#define SIGN_COMMON_UTILS_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace sign
+{
+    namespace common
+    {
+
+        namespace detail
+        {
+            // 現在のスレッドが確保したバイト数（allocation_hook.cpp の operator new が加算する）
+            // 定数で初期化する自明な型なので、アクセスに初期化の確認は入らない
+            inline thread_local std::uint64_t allocatedBytes = 0;
+
+            // allocation_hook.cpp がリンクされている（静的初期化で設定される）
+            inline bool hookLinked = false;
+        }
+
+        // メモリ確保量を数えているか（allocation_hook.cpp をリンクし、SIGN_NO_STATS を指定していない）
+        bool allocationCountingEnabled();
+
+        // 現在のスレッドがこれまでに operator new で確保したバイト数（解放分は差し引かない）
+        std::uint64_t threadAllocatedBytes();
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_UTILS_ALLOCATION_COUNTER_H
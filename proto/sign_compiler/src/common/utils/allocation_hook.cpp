@@ -0,0 +1,55 @@
+// src/common/utils/allocation_hook.cpp
+/**
+ * メモリ確保量を数えるためのグローバルな operator new の置き換え
+ *
+ * プロセスのすべての確保に加算が入るため、統計を出す実行ファイル（sign_compiler とベンチマーク）にだけリンクし、
+ * プリプロセッサ本体のソース（build-bench.sh の SOURCES）には含めない。
+ * 配列版・nothrow版の operator new は標準ライブラリの既定の実装がこの operator new を呼ぶため、
+ * 置き換えるのは通常版とそれに対応する operator delete のみ
+ *
+ * ver_20261016_0
+ */
+
+#include "common/utils/allocation_counter.h"
+#include <cstdlib>
+#include <new>
+
+#ifndef SIGN_NO_STATS
+
+namespace
+{
+    // リンクされたことを統計の出力に伝える
+    const bool hookLinked = (sign::common::detail::hookLinked = true);
+}
+
+void *operator new(std::size_t size)
+{
+    sign::common::detail::allocatedBytes += size;
+    for (;;)
+    {
+        if (void *p = std::malloc(size > 0 ? size : 1))
+        {
+            return p;
+        }
+
+        // 確保に失敗した場合は new_handler に任せる（未設定なら例外）
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#endif // SIGN_NO_STATS
@@ -0,0 +1,75 @@
+// src/common/utils/hash.h
+/**
+ * バイト列の高速な64ビットハッシュを提供するモジュール
+ *
+ * 機能:
+ * - 8バイト単位で読み込む非暗号学的ハッシュ（MurmurHash64A 方式）
+ * - ブロックの変更検出やキャッシュのキーに使用する
+ *
+ * ver_20261016_0
+ */
+#ifndef SIGN_COMMON_UTILS_HASH_H
+#define SIGN_COMMON_UTILS_HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace sign
+{
+    namespace common
+    {
+
+        /**
+         * バイト列の64ビットハッシュを計算する
+         *
+         * @param data 対象のバイト列
+         * @param seed 初期値（用途ごとに変えるとキーの衝突を避けられる）
+         * @return ハッシュ値
+         */
+        inline std::uint64_t hashBytes(std::string_view data, std::uint64_t seed = 0)
+        {
+            constexpr std::uint64_t m = 0xc6a4a7935bd1e995ULL;
+            constexpr int r = 47;
+
+            const size_t length = data.size();
+            std::uint64_t h = seed ^ (length * m);
+
+            const char *p = data.data();
+            const char *end = p + (length & ~size_t(7));
+            for (; p != end; p += 8)
+            {
+                std::uint64_t k;
+                std::memcpy(&k, p, sizeof(k));
+
+                k *= m;
+                k ^= k >> r;
+                k *= m;
+
+                h ^= k;
+                h *= m;
+            }
+
+            // 8バイトに満たない末尾
+            const size_t tail = length & 7;
+            if (tail != 0)
+            {
+                std::uint64_t k = 0;
+                for (size_t i = 0; i < tail; ++i)
+                {
+                    k |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+                }
+                h ^= k;
+                h *= m;
+            }
+
+            h ^= h >> r;
+            h *= m;
+            h ^= h >> r;
+            return h;
+        }
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_UTILS_HASH_H
@@ -0,0 +1,150 @@
+// src/common/utils/output_sink.cpp
+/**
+ * 処理結果を逐次書き出す出力先の実装
+ *
+ * ver_20261016_1
+ */
+
+#include "common/utils/output_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace sign
+{
+    namespace common
+    {
+
+        FileSink::FileSink(const std::string &path, size_t bufferBytes)
+            : capacity(bufferBytes > 0 ? bufferBytes : 1)
+        {
+            if (path == "-")
+            {
+                fd = 1; // 標準出力
+            }
+            else
+            {
+                // 処理に失敗しても既存の出力ファイルを壊さないよう、一時ファイルに書き込む
+                // std::ofstream と同じく既定のモードで開く（Windowsでは改行を変換する）
+                this->path = path;
+                temporaryPath = path + ".tmp";
+                fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                ownsFd = fd >= 0;
+            }
+            failed = fd < 0;
+            buffer.reserve(capacity);
+        }
+
+        FileSink::~FileSink()
+        {
+            if (ownsFd)
+            {
+                // close() されずに破棄された（例外などで処理を中断した）出力は残さない
+                discard();
+            }
+            else
+            {
+                flush();
+            }
+        }
+
+        void FileSink::writeBytes(std::string_view data)
+        {
+            if (buffer.size() + data.size() <= capacity)
+            {
+                buffer.append(data);
+                return;
+            }
+
+            // バッファに収まらない場合は、先にバッファを書き出す
+            flush();
+            if (data.size() >= capacity)
+            {
+                writeAll(data);
+            }
+            else
+            {
+                buffer.append(data);
+            }
+        }
+
+        void FileSink::writeAll(std::string_view data)
+        {
+            while (!data.empty() && !failed)
+            {
+                // 一度に書き込めるとは限らないので、残りがなくなるまで繰り返す
+                const unsigned int chunk = static_cast<unsigned int>(std::min<size_t>(data.size(), 1u << 30));
+                const auto written = ::write(fd, data.data(), chunk);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    failed = true;
+                    break;
+                }
+                data.remove_prefix(static_cast<size_t>(written));
+            }
+        }
+
+        bool FileSink::flush()
+        {
+            if (fd >= 0 && !buffer.empty())
+            {
+                writeAll(buffer);
+            }
+            buffer.clear();
+            return !failed;
+        }
+
+        bool FileSink::close()
+        {
+            flush();
+            if (!ownsFd)
+            {
+                fd = -1;
+                return !failed;
+            }
+
+            if (::close(fd) != 0)
+            {
+                failed = true;
+            }
+            ownsFd = false;
+            fd = -1;
+
+            // すべて書き込めた場合のみ出力ファイルを置き換える
+            std::error_code ec;
+            if (!failed)
+            {
+                std::filesystem::rename(temporaryPath, path, ec);
+                failed = static_cast<bool>(ec);
+            }
+            if (failed)
+            {
+                std::filesystem::remove(temporaryPath, ec);
+            }
+            return !failed;
+        }
+
+        void FileSink::discard()
+        {
+            buffer.clear();
+            ::close(fd);
+            ownsFd = false;
+            fd = -1;
+            failed = true;
+            std::error_code ec;
+            std::filesystem::remove(temporaryPath, ec);
+        }
+
+    } // namespace common
+} // namespace sign
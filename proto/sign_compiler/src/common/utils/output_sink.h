@@ -0,0 +1,154 @@
+// src/common/utils/output_sink.h
+/**
+ * 処理結果を逐次書き出す出力先の抽象化
+ *
+ * 機能:
+ * - 出力先の共通インターフェース（書き込みバイト数の集計付き）
+ * - 大きなバッファでまとめて書き込むファイル記述子への出力（"-" は標準出力）
+ * - ファイルへの出力は一時ファイルに書き込み、すべて成功した場合のみ名前を変更して置き換える
+ * - 文字列への出力と、2つの出力先への同時出力
+ *
+ * ver_20261016_1
+ */
+#ifndef SIGN_COMMON_UTILS_OUTPUT_SINK_H
+#define SIGN_COMMON_UTILS_OUTPUT_SINK_H
+
+#include <string>
+#include <string_view>
+
+namespace sign
+{
+    namespace common
+    {
+
+        // 出力先の基底クラス
+        class OutputSink
+        {
+        public:
+            virtual ~OutputSink() = default;
+
+            // データを書き込む（エラーは flush() の戻り値で通知する）
+            void write(std::string_view data)
+            {
+                bytes += data.size();
+                writeBytes(data);
+            }
+
+            /**
+             * バッファ中のデータを出力先に書き出す
+             *
+             * @return これまでの書き込みがすべて成功した場合はtrue
+             */
+            virtual bool flush() = 0;
+
+            // 書き込んだバイト数
+            size_t bytesWritten() const { return bytes; }
+
+        protected:
+            virtual void writeBytes(std::string_view data) = 0;
+
+        private:
+            size_t bytes = 0;
+        };
+
+        // 文字列に書き込む出力先
+        class StringSink : public OutputSink
+        {
+        public:
+            bool flush() override { return true; }
+
+            // 書き込んだ内容を取り出す
+            std::string take() { return std::move(text); }
+
+        protected:
+            void writeBytes(std::string_view data) override { text.append(data); }
+
+        private:
+            std::string text;
+        };
+
+        /**
+         * ファイル記述子に書き込む出力先
+         * 小さな書き込みはバッファにまとめ、バッファより大きな書き込みは直接書き出す
+         * ファイルへの出力は <出力ファイル名>.tmp に書き込み、close() ですべて成功していれば出力ファイルを置き換える
+         * （失敗した場合や close() せずに破棄した場合は一時ファイルを削除し、既存の出力ファイルは変わらない）
+         */
+        class FileSink : public OutputSink
+        {
+        public:
+            // 既定のバッファサイズ（1MB）
+            static constexpr size_t DEFAULT_BUFFER_BYTES = size_t(1) << 20;
+
+            /**
+             * 出力先の一時ファイルを開く
+             *
+             * @param path 出力ファイル名（"-" なら標準出力）
+             * @param bufferBytes バッファサイズ
+             */
+            explicit FileSink(const std::string &path, size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+
+            // 閉じていなければ一時ファイルを削除する（標準出力は残りを書き出す）
+            ~FileSink() override;
+
+            FileSink(const FileSink &) = delete;
+            FileSink &operator=(const FileSink &) = delete;
+
+            // 開けたかどうか
+            bool isOpen() const { return fd >= 0; }
+
+            bool flush() override;
+
+            /**
+             * 残りを書き出して閉じ、すべて成功していれば一時ファイルで出力ファイルを置き換える（標準出力は閉じない）
+             *
+             * @return これまでの書き込みと閉じる処理・置き換えがすべて成功した場合はtrue
+             */
+            bool close();
+
+        protected:
+            void writeBytes(std::string_view data) override;
+
+        private:
+            // バッファを介さずにすべて書き出す
+            void writeAll(std::string_view data);
+
+            // 一時ファイルを閉じて削除する
+            void discard();
+
+            std::string path;          // 出力ファイル名（標準出力なら空）
+            std::string temporaryPath; // 書き込み中の一時ファイル名
+            int fd = -1;
+            bool ownsFd = false;
+            bool failed = false;
+            size_t capacity;
+            std::string buffer;
+        };
+
+        // 2つの出力先に同じ内容を書き込む出力先
+        class TeeSink : public OutputSink
+        {
+        public:
+            TeeSink(OutputSink &first, OutputSink &second) : first(first), second(second) {}
+
+            bool flush() override
+            {
+                const bool firstOk = first.flush();
+                return second.flush() && firstOk;
+            }
+
+        protected:
+            void writeBytes(std::string_view data) override
+            {
+                first.write(data);
+                second.write(data);
+            }
+
+        private:
+            OutputSink &first;
+            OutputSink &second;
+        };
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_UTILS_OUTPUT_SINK_H
@@ -3,10 +3,11 @@
  * Sign言語の文字列操作ユーティリティを実装
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_0
  */
 
 #include "common/utils/string_utils.h"
+#include "common/lexer/structural_index.h"
 #include <sstream>
 
 namespace sign
@@ -22,20 +23,31 @@ namespace sign
                 return "";
             }
 
-            // 行分割
-            std::vector<std::string> lines = splitLines(sourceCode);
+            // 改行位置は構造文字索引から取得する
+            const StructuralIndex index(sourceCode);
 
-            // 処理済み行を格納
-            std::vector<std::string> processedLines;
+            // 処理済み行を改行で結合しながら格納
+            std::string result;
+            result.reserve(sourceCode.size());
+            bool firstLine = true;
 
             // 各行を処理
-            for (const auto &line : lines)
+            size_t lineStart = 0;
+            while (lineStart < sourceCode.size())
             {
+                size_t lineEnd = index.nextNewline(lineStart);
+                if (lineEnd == StructuralIndex::npos)
+                {
+                    lineEnd = sourceCode.size();
+                }
+                std::string_view line(sourceCode.data() + lineStart, lineEnd - lineStart);
+                lineStart = lineEnd + 1;
+
                 // 空白を除いた行頭文字をチェック
                 size_t firstNonSpace = line.find_first_not_of(" \t");
 
                 // 行全体が空白の場合はスキップ
-                if (firstNonSpace == std::string::npos)
+                if (firstNonSpace == std::string_view::npos)
                 {
                     continue;
                 }
@@ -46,76 +58,57 @@ namespace sign
                     continue; // コメント行をスキップ
                 }
 
-                // 行末の空白を削除
-                std::string trimmedLine = trimRight(line);
-
-                // 空でない行のみ追加
-                if (!trimmedLine.empty())
+                // 行末の空白を削除して追加
+                if (!firstLine)
                 {
-                    processedLines.push_back(trimmedLine);
+                    result += '\n';
                 }
+                result.append(line.substr(0, line.find_last_not_of(" \t") + 1));
+                firstLine = false;
             }
 
-            // 結合して返す
-            return joinLines(processedLines);
+            return result;
         }
 
         // ブレースケット統一
         std::string unifyBrackets(const std::string &sourceCode)
         {
-            // 文字列リテラル内のカッコは変換しないよう注意する必要がある
-            // バッククォートで囲まれた部分を一時的に置換して保護
-            std::vector<std::string> stringLiterals;
-            std::string protectedCode = sourceCode;
-
-            // 文字列リテラルを保護
-            size_t start = 0;
-            while ((start = protectedCode.find('`', start)) != std::string::npos)
+            std::string result = sourceCode;
+            unifyBrackets(result, StructuralIndex(result));
+            return result;
+        }
+
+        // ブレースケット統一（索引を利用してその場で変換）
+        void unifyBrackets(std::string &code, const StructuralIndex &index)
+        {
+            // 構造文字だけを辿り、バッククォートで囲まれた文字列リテラル内のカッコは変換しない
+            size_t pos = index.nextStructural(0);
+            while (pos != StructuralIndex::npos)
             {
-                size_t end = protectedCode.find('`', start + 1);
-                if (end == std::string::npos)
+                const char c = code[pos];
+                if (c == '`')
                 {
-                    break; // 閉じていないバッククォートがある場合
+                    // 閉じバッククォートまで読み飛ばす（閉じていない場合は保護しない）
+                    size_t close = index.nextStructural(pos + 1);
+                    while (close != StructuralIndex::npos && code[close] != '`')
+                    {
+                        close = index.nextStructural(close + 1);
+                    }
+                    if (close != StructuralIndex::npos)
+                    {
+                        pos = close;
+                    }
                 }
-
-                // 文字列リテラルを抽出して保存
-                std::string literal = protectedCode.substr(start, end - start + 1);
-                stringLiterals.push_back(literal);
-
-                // プレースホルダーに置換
-                std::string placeholder = "STRING_LITERAL_" + std::to_string(stringLiterals.size() - 1) + "_";
-                protectedCode.replace(start, end - start + 1, placeholder);
-
-                // 次の検索位置を更新
-                start += placeholder.length();
-            }
-
-            // すべての丸カッコと波カッコを角カッコに変換
-            for (size_t i = 0; i < protectedCode.length(); ++i)
-            {
-                if (protectedCode[i] == '(')
-                    protectedCode[i] = '[';
-                else if (protectedCode[i] == ')')
-                    protectedCode[i] = ']';
-                else if (protectedCode[i] == '{')
-                    protectedCode[i] = '[';
-                else if (protectedCode[i] == '}')
-                    protectedCode[i] = ']';
-            }
-
-            // 文字列リテラルを元に戻す
-            for (size_t i = 0; i < stringLiterals.size(); ++i)
-            {
-                std::string placeholder = "STRING_LITERAL_" + std::to_string(i) + "_";
-                size_t pos = 0;
-                while ((pos = protectedCode.find(placeholder, pos)) != std::string::npos)
+                else if (c == '(' || c == '{')
                 {
-                    protectedCode.replace(pos, placeholder.length(), stringLiterals[i]);
-                    pos += stringLiterals[i].length();
+                    code[pos] = '[';
                 }
+                else if (c == ')' || c == '}')
+                {
+                    code[pos] = ']';
+                }
+                pos = index.nextStructural(pos + 1);
             }
-
-            return protectedCode;
         }
 
         // 文字列を行に分割
@@ -9,7 +9,7 @@
  * - 空白の正規化
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_0
  */
 
 #ifndef SIGN_COMMON_UTILS_STRING_UTILS_H
@@ -23,6 +23,8 @@ namespace sign
     namespace common
     {
 
+        class StructuralIndex;
+
         /**
          * コメント除去
          * @param sourceCode 処理対象のソースコード
@@ -37,6 +39,14 @@ namespace sign
          */
         std::string unifyBrackets(const std::string &sourceCode);
 
+        /**
+         * カッコの統一（構造文字索引を利用してその場で変換）
+         * カッコの変換は構造文字の位置を変えないため、索引は変換後も有効
+         * @param code 処理対象のソースコード（変換結果で上書き）
+         * @param index codeの構造文字索引
+         */
+        void unifyBrackets(std::string &code, const StructuralIndex &index);
+
         /**
          * 文字列を行に分割
          * @param source 分割する文字列
@@ -0,0 +1,179 @@
+// src/common/utils/thread_pool.cpp
+/**
+ * ワークスティーリング方式のスレッドプールの実装
+ *
+ * ver_20261016_1
+ */
+
+#include "common/utils/thread_pool.h"
+#include <chrono>
+
+namespace sign
+{
+    namespace common
+    {
+
+        namespace
+        {
+            // 現在のスレッドが属するプールとワーカー番号
+            thread_local const void *currentPool = nullptr;
+            thread_local size_t currentWorker = 0;
+        }
+
+        ThreadPool::ThreadPool(size_t jobs)
+        {
+            if (jobs == 0)
+            {
+                jobs = std::max<size_t>(1, std::thread::hardware_concurrency());
+            }
+
+            const size_t workerCount = jobs - 1;
+            for (size_t i = 0; i <= workerCount; ++i)
+            {
+                queues.push_back(std::make_unique<WorkQueue>());
+            }
+            workers.reserve(workerCount);
+            for (size_t i = 0; i < workerCount; ++i)
+            {
+                workers.emplace_back([this, i]()
+                                     { workerLoop(i); });
+            }
+        }
+
+        ThreadPool::~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                stopping = true;
+            }
+            wakeUp.notify_all();
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        void ThreadPool::submit(Task task)
+        {
+            // ワーカーからの投入は自分のキュー、外部からの投入は順番に分散する
+            size_t index;
+            if (currentPool == this)
+            {
+                index = currentWorker;
+            }
+            else
+            {
+                index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(queues[index]->mutex);
+                queues[index]->tasks.push_back(std::move(task));
+            }
+            pending.fetch_add(1, std::memory_order_release);
+
+            // 眠っているワーカーを起こす（待機判定と競合しないようロックを経由する）
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+            }
+            wakeUp.notify_one();
+        }
+
+        bool ThreadPool::popTask(size_t home, Task &task)
+        {
+            if (pending.load(std::memory_order_acquire) == 0)
+            {
+                return false;
+            }
+
+            // 自分のキューは後ろから（直前に積んだタスクを優先）
+            {
+                WorkQueue &queue = *queues[home];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty())
+                {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    pending.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+
+            // 他のキューからは前から盗む
+            for (size_t offset = 1; offset < queues.size(); ++offset)
+            {
+                WorkQueue &queue = *queues[(home + offset) % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty())
+                {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    pending.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool ThreadPool::runPendingTask()
+        {
+            // ワーカー以外のスレッドは外部投入用キューを自分のキューとして扱う
+            const size_t home = (currentPool == this) ? currentWorker : queues.size() - 1;
+            Task task;
+            if (!popTask(home, task))
+            {
+                return false;
+            }
+            task();
+            return true;
+        }
+
+        void ThreadPool::workerLoop(size_t index)
+        {
+            currentPool = this;
+            currentWorker = index;
+            trace::setThreadName("worker " + std::to_string(index + 1));
+
+            Task task;
+            while (true)
+            {
+                if (popTask(index, task))
+                {
+                    task();
+                    task = nullptr;
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                wakeUp.wait(lock, [this]()
+                            { return stopping || pending.load(std::memory_order_acquire) > 0; });
+                if (stopping && pending.load(std::memory_order_acquire) == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        void ThreadPool::wait(TaskGroup &group)
+        {
+            // 待機中も他のタスクを実行して処理に参加する
+            while (group.remaining.load(std::memory_order_acquire) > 0)
+            {
+                if (runPendingTask())
+                {
+                    continue;
+                }
+
+                // 実行できるタスクがなければ、残りのタスクの完了を待つ
+                // （残りは他のスレッドが実行中なので、一定時間ごとに新しいタスクを確認する）
+                std::unique_lock<std::mutex> lock(group.mutex);
+                group.done.wait_for(lock, std::chrono::milliseconds(1), [&group]()
+                                    { return group.remaining.load(std::memory_order_acquire) == 0; });
+            }
+
+            // 最後のタスクがロックを手放すまで group を破棄しない
+            std::lock_guard<std::mutex> lock(group.mutex);
+        }
+
+    } // namespace common
+} // namespace sign
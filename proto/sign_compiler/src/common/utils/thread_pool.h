@@ -0,0 +1,198 @@
+// src/common/utils/thread_pool.h
+/**
+ * 処理を複数スレッドに分散するワークスティーリング方式のスレッドプール
+ *
+ * 機能:
+ * - ワーカーごとのタスクキュー（自分のキューは後ろから、他のキューは前から盗む）
+ * - 呼び出し元も処理に参加する parallelFor（入れ子で呼んでもデッドロックしない）
+ * - タスク内の例外を呼び出し元に再送出
+ * - parallelFor の各タスクとワーカースレッドの名前をトレースに記録
+ *
+ * ver_20261016_1
+ */
+#ifndef SIGN_COMMON_UTILS_THREAD_POOL_H
+#define SIGN_COMMON_UTILS_THREAD_POOL_H
+
+#include "common/utils/trace.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sign
+{
+    namespace common
+    {
+
+        class ThreadPool
+        {
+        public:
+            using Task = std::function<void()>;
+
+            /**
+             * スレッドプールを生成する
+             * 呼び出し元スレッドも処理に参加するため、ワーカーは jobs - 1 個生成する
+             *
+             * @param jobs 同時に実行するスレッド数（0ならハードウェアのスレッド数）
+             */
+            explicit ThreadPool(size_t jobs = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool &) = delete;
+            ThreadPool &operator=(const ThreadPool &) = delete;
+
+            // 呼び出し元を含めた同時実行数
+            size_t concurrency() const { return workers.size() + 1; }
+
+            /**
+             * タスクを投入する
+             * ワーカーから呼んだ場合はそのワーカーのキューに積む
+             * タスクは例外を送出してはならない（例外を扱う場合は parallelFor を使う）
+             *
+             * @param task 実行するタスク
+             */
+            void submit(Task task);
+
+            /**
+             * 待機中のタスクを1つ取り出して現在のスレッドで実行する
+             *
+             * @return タスクを実行した場合はtrue
+             */
+            bool runPendingTask();
+
+            /**
+             * [0, count) の各インデックスについて body(index) を並列に実行し、全て終わるまで待つ
+             * 呼び出し元も待機中のタスクを実行するため、タスク内から入れ子で呼び出せる
+             *
+             * @param count インデックスの数
+             * @param body 各インデックスで実行する処理
+             * @param grain 1タスクにまとめるインデックスの数（0なら自動）
+             */
+            template <typename Body>
+            void parallelFor(size_t count, Body &&body, size_t grain = 0);
+
+            /**
+             * プールを使わずに直列実行するか、プールで並列実行する parallelFor
+             *
+             * @param pool スレッドプール（nullptrなら直列実行）
+             */
+            template <typename Body>
+            static void parallelFor(ThreadPool *pool, size_t count, Body &&body, size_t grain = 0);
+
+        private:
+            // ワーカーごとのタスクキュー
+            struct WorkQueue
+            {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+            };
+
+            // parallelFor 1回分の完了待ち
+            struct TaskGroup
+            {
+                std::atomic<size_t> remaining{0};
+                std::mutex mutex;
+                std::condition_variable done;
+                std::exception_ptr error;
+            };
+
+            void workerLoop(size_t index);
+            bool popTask(size_t home, Task &task);
+            void wait(TaskGroup &group);
+
+            std::vector<std::unique_ptr<WorkQueue>> queues; // ワーカーごと + 外部投入用（末尾）
+            std::vector<std::thread> workers;
+            std::atomic<size_t> pending{0}; // 待機中のタスク数
+            std::atomic<size_t> nextQueue{0};
+            std::mutex sleepMutex;
+            std::condition_variable wakeUp;
+            bool stopping = false;
+        };
+
+        template <typename Body>
+        void ThreadPool::parallelFor(size_t count, Body &&body, size_t grain)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            if (workers.empty() || count == 1)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    body(i);
+                }
+                return;
+            }
+
+            // 盗み合いで負荷が均等になるよう、スレッド数より十分多いタスクに分割する
+            if (grain == 0)
+            {
+                grain = std::max<size_t>(1, count / (concurrency() * 8));
+            }
+            const size_t taskCount = (count + grain - 1) / grain;
+
+            TaskGroup group;
+            group.remaining.store(taskCount, std::memory_order_relaxed);
+            for (size_t t = 0; t < taskCount; ++t)
+            {
+                const size_t begin = t * grain;
+                const size_t end = std::min(count, begin + grain);
+                submit([&group, &body, begin, end]()
+                       {
+                           try
+                           {
+                               TraceSpan span("task", "count", static_cast<std::int64_t>(end - begin));
+                               for (size_t i = begin; i < end; ++i)
+                               {
+                                   body(i);
+                               }
+                           }
+                           catch (...)
+                           {
+                               std::lock_guard<std::mutex> lock(group.mutex);
+                               if (!group.error)
+                               {
+                                   group.error = std::current_exception();
+                               }
+                           }
+                           // 完了の通知はロック内で行い、待機側が group を破棄する前に終える
+                           std::lock_guard<std::mutex> lock(group.mutex);
+                           if (group.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                           {
+                               group.done.notify_all();
+                           } });
+            }
+
+            wait(group);
+            if (group.error)
+            {
+                std::rethrow_exception(group.error);
+            }
+        }
+
+        template <typename Body>
+        void ThreadPool::parallelFor(ThreadPool *pool, size_t count, Body &&body, size_t grain)
+        {
+            if (pool != nullptr)
+            {
+                pool->parallelFor(count, std::forward<Body>(body), grain);
+                return;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                body(i);
+            }
+        }
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_UTILS_THREAD_POOL_H
@@ -0,0 +1,248 @@
+// src/common/utils/trace.cpp
+/**
+ * 処理の区間を記録するトレースの実装
+ *
+ * 各スレッドは最初のイベントを記録するときに一度だけ自分のバッファを登録し（ここだけロックを取る）、
+ * 以降は自分のバッファの末尾に追加するだけになる。バッファは固定長のチャンクを連ねたもので、
+ * 追加時に既存のイベントを移動しないため、記録の所要時間がばらつかない。
+ *
+ * ver_20261016_0
+ */
+
+#include "common/utils/trace.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sign
+{
+    namespace common
+    {
+
+        namespace
+        {
+            // チャンク1つあたりのイベント数
+            constexpr size_t CHUNK_EVENTS = 1024;
+
+            // スレッド1つのイベントバッファ（所有するスレッドだけが追加する）
+            struct ThreadBuffer
+            {
+                std::uint32_t tid = 0;
+                std::string name;
+                std::vector<std::unique_ptr<TraceEvent[]>> chunks;
+                size_t lastChunkSize = 0; // 末尾のチャンクに入っているイベント数
+
+                void clear()
+                {
+                    chunks.clear();
+                    lastChunkSize = 0;
+                }
+
+                void append(TraceEvent &&event)
+                {
+                    if (chunks.empty() || lastChunkSize == CHUNK_EVENTS)
+                    {
+                        chunks.push_back(std::make_unique<TraceEvent[]>(CHUNK_EVENTS));
+                        lastChunkSize = 0;
+                    }
+                    chunks.back()[lastChunkSize++] = std::move(event);
+                }
+
+                template <typename Visit>
+                void forEach(Visit &&visit) const
+                {
+                    for (size_t c = 0; c < chunks.size(); ++c)
+                    {
+                        const size_t count = (c + 1 == chunks.size()) ? lastChunkSize : CHUNK_EVENTS;
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            visit(chunks[c][i]);
+                        }
+                    }
+                }
+            };
+
+            // 全スレッドのバッファ（スレッドの終了後も出力まで保持する）
+            struct Registry
+            {
+                std::mutex mutex;
+                std::vector<std::unique_ptr<ThreadBuffer>> threads;
+            };
+
+            Registry &registry()
+            {
+                static Registry instance;
+                return instance;
+            }
+
+            // 記録開始時刻（steady_clock のナノ秒）
+            std::atomic<std::int64_t> epoch{0};
+
+            thread_local ThreadBuffer *currentBuffer = nullptr;
+            thread_local std::string currentName;
+
+            std::int64_t clockNanoseconds()
+            {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            ThreadBuffer &threadBuffer()
+            {
+                if (currentBuffer == nullptr)
+                {
+                    Registry &r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    auto buffer = std::make_unique<ThreadBuffer>();
+                    buffer->tid = static_cast<std::uint32_t>(r.threads.size() + 1);
+                    buffer->name = currentName.empty() ? "thread " + std::to_string(buffer->tid) : currentName;
+                    currentBuffer = buffer.get();
+                    r.threads.push_back(std::move(buffer));
+                }
+                return *currentBuffer;
+            }
+
+            // JSON の文字列として出力する
+            void writeJsonString(std::ostream &out, const std::string &text)
+            {
+                static const char HEX[] = "0123456789abcdef";
+                out << '"';
+                for (const char c : text)
+                {
+                    switch (c)
+                    {
+                    case '"':
+                        out << "\\\"";
+                        break;
+                    case '\\':
+                        out << "\\\\";
+                        break;
+                    case '\n':
+                        out << "\\n";
+                        break;
+                    case '\t':
+                        out << "\\t";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20)
+                        {
+                            out << "\\u00" << HEX[(c >> 4) & 0xF] << HEX[c & 0xF];
+                        }
+                        else
+                        {
+                            out << c;
+                        }
+                        break;
+                    }
+                }
+                out << '"';
+            }
+
+            // ナノ秒をマイクロ秒（小数点以下3桁）で出力する（浮動小数点の書式に依存しない）
+            void writeMicroseconds(std::ostream &out, std::uint64_t nanoseconds)
+            {
+                const std::uint64_t fraction = nanoseconds % 1000;
+                out << nanoseconds / 1000 << '.' << static_cast<char>('0' + fraction / 100)
+                    << static_cast<char>('0' + fraction / 10 % 10) << static_cast<char>('0' + fraction % 10);
+            }
+        } // namespace
+
+        namespace trace
+        {
+
+            void start()
+            {
+                if (!TRACING_AVAILABLE)
+                {
+                    return;
+                }
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                for (auto &buffer : r.threads)
+                {
+                    buffer->clear();
+                }
+                epoch.store(clockNanoseconds(), std::memory_order_relaxed);
+                active.store(true, std::memory_order_release);
+            }
+
+            void stop()
+            {
+                active.store(false, std::memory_order_release);
+            }
+
+            std::uint64_t now()
+            {
+                const std::int64_t elapsed = clockNanoseconds() - epoch.load(std::memory_order_relaxed);
+                return elapsed > 0 ? static_cast<std::uint64_t>(elapsed) : 0;
+            }
+
+            void record(TraceEvent &&event)
+            {
+                threadBuffer().append(std::move(event));
+            }
+
+            void setThreadName(const std::string &name)
+            {
+                if (!TRACING_AVAILABLE)
+                {
+                    return;
+                }
+                currentName = name;
+                if (currentBuffer != nullptr)
+                {
+                    std::lock_guard<std::mutex> lock(registry().mutex);
+                    currentBuffer->name = name;
+                }
+            }
+
+            bool writeChromeTrace(std::ostream &out)
+            {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+
+                out << "{\"traceEvents\":[\n";
+                out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"sign_compiler\"}}";
+                for (const auto &buffer : r.threads)
+                {
+                    // スレッド名と、登録順に並べるための順序
+                    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+                    writeJsonString(out, buffer->name);
+                    out << "}}";
+                    out << ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                        << ",\"args\":{\"sort_index\":" << buffer->tid << "}}";
+
+                    buffer->forEach([&](const TraceEvent &event)
+                                    {
+                                        out << ",\n{\"name\":";
+                                        writeJsonString(out, event.name != nullptr ? event.name : "");
+                                        out << ",\"cat\":\"sign\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":";
+                                        writeMicroseconds(out, event.start);
+                                        out << ",\"dur\":";
+                                        writeMicroseconds(out, event.duration);
+                                        if (event.argName != nullptr || !event.detail.empty())
+                                        {
+                                            out << ",\"args\":{";
+                                            if (event.argName != nullptr)
+                                            {
+                                                writeJsonString(out, event.argName);
+                                                out << ':' << event.argValue;
+                                            }
+                                            if (!event.detail.empty())
+                                            {
+                                                out << (event.argName != nullptr ? "," : "") << "\"detail\":";
+                                                writeJsonString(out, event.detail);
+                                            }
+                                            out << '}';
+                                        }
+                                        out << '}'; });
+                }
+                out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+                out.flush();
+                return static_cast<bool>(out);
+            }
+
+        } // namespace trace
+
+    } // namespace common
+} // namespace sign
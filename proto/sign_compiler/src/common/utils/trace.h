@@ -0,0 +1,151 @@
+// src/common/utils/trace.h
+/**
+ * 処理の区間を記録するトレース（Chrome trace event 形式で出力）
+ *
+ * 機能:
+ * - スコープの開始から終了までを1つの区間として記録する TraceSpan
+ * - スレッドごとのイベントバッファ（記録時にロックを取らず、他のスレッドと競合しない）
+ * - スレッド名の登録と、chrome://tracing や Perfetto で読める JSON の出力
+ *
+ * 記録していないときの TraceSpan の費用は、有効かどうかのフラグを1回読むだけ。
+ * SIGN_NO_TRACE を定義してビルドした場合、TraceSpan は何もしないクラスになる。
+ *
+ * ver_20261016_0
+ */
+#ifndef SIGN_COMMON_UTILS_TRACE_H
+#define SIGN_COMMON_UTILS_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace sign
+{
+    namespace common
+    {
+
+        // トレースを取れるビルドかどうか
+#ifdef SIGN_NO_TRACE
+        constexpr bool TRACING_AVAILABLE = false;
+#else
+        constexpr bool TRACING_AVAILABLE = true;
+#endif
+
+        // 記録した区間1つ
+        struct TraceEvent
+        {
+            const char *name = nullptr;    // 区間の名前（文字列リテラルなど、出力時まで有効なもの）
+            std::uint64_t start = 0;       // 開始時刻（記録開始からのナノ秒）
+            std::uint64_t duration = 0;    // 長さ（ナノ秒）
+            const char *argName = nullptr; // 整数の引数の名前（なければ nullptr）
+            std::int64_t argValue = 0;     // 整数の引数の値
+            std::string detail;            // 文字列の引数（ファイル名など、なければ空）
+        };
+
+        /**
+         * トレースの記録（プロセス全体で1つ）
+         * start と writeChromeTrace は、他のスレッドが区間を記録していないときに呼ぶ
+         */
+        namespace trace
+        {
+            // 記録中かどうか（TraceSpan から毎回読むため、インラインの変数にする）
+            inline std::atomic<bool> active{false};
+
+            // 記録中かどうか
+            inline bool enabled()
+            {
+                return active.load(std::memory_order_relaxed);
+            }
+
+            // 記録を開始する（それまでのイベントは破棄する）
+            void start();
+
+            // 記録を終了する
+            void stop();
+
+            // 記録開始からの経過時間（ナノ秒）
+            std::uint64_t now();
+
+            // 現在のスレッドにイベントを追加する
+            void record(TraceEvent &&event);
+
+            // 現在のスレッドの名前を設定する（トレースのスレッド名として表示される）
+            void setThreadName(const std::string &name);
+
+            /**
+             * 記録したイベントを Chrome trace event 形式の JSON で出力する
+             *
+             * @param out 出力先
+             * @return 出力に成功した場合はtrue
+             */
+            bool writeChromeTrace(std::ostream &out);
+        } // namespace trace
+
+#ifndef SIGN_NO_TRACE
+
+        // スコープの開始から終了までを区間として記録する
+        class TraceSpan
+        {
+        public:
+            /**
+             * 区間を開始する
+             *
+             * @param name 区間の名前（文字列リテラルなど、出力時まで有効なもの）
+             * @param argName 整数の引数の名前（なければ nullptr）
+             * @param argValue 整数の引数の値
+             */
+            explicit TraceSpan(const char *name, const char *argName = nullptr, std::int64_t argValue = 0)
+                : recording(trace::enabled())
+            {
+                if (recording)
+                {
+                    event.name = name;
+                    event.argName = argName;
+                    event.argValue = argValue;
+                    event.start = trace::now();
+                }
+            }
+
+            // 文字列の引数付きで区間を開始する
+            TraceSpan(const char *name, const std::string &detail)
+                : TraceSpan(name)
+            {
+                if (recording)
+                {
+                    event.detail = detail;
+                }
+            }
+
+            ~TraceSpan()
+            {
+                if (recording)
+                {
+                    event.duration = trace::now() - event.start;
+                    trace::record(std::move(event));
+                }
+            }
+
+            TraceSpan(const TraceSpan &) = delete;
+            TraceSpan &operator=(const TraceSpan &) = delete;
+
+        private:
+            bool recording;
+            TraceEvent event;
+        };
+
+#else
+
+        class TraceSpan
+        {
+        public:
+            explicit TraceSpan(const char *, const char * = nullptr, std::int64_t = 0) {}
+            TraceSpan(const char *, const std::string &) {}
+        };
+
+#endif // SIGN_NO_TRACE
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_UTILS_TRACE_H
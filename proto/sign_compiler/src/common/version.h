@@ -0,0 +1,30 @@
+// src/common/version.h
+/**
+ * Sign言語コンパイラのバージョン情報
+ *
+ * 前処理の結果が変わる変更（変換規則・出力形式・トークンの種類の変更）を行った場合は
+ * PREPROCESS_FORMAT_VERSION を上げること（前処理キャッシュのキーに含まれる）
+ *
+ * ver_20261016_4
+ */
+#ifndef SIGN_COMMON_VERSION_H
+#define SIGN_COMMON_VERSION_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace sign
+{
+    namespace common
+    {
+
+        // コンパイラのバージョン
+        inline constexpr std::string_view COMPILER_VERSION = "0.1.0";
+
+        // 前処理の結果の形式のバージョン
+        inline constexpr std::uint32_t PREPROCESS_FORMAT_VERSION = 5;
+
+    } // namespace common
+} // namespace sign
+
+#endif // SIGN_COMMON_VERSION_H
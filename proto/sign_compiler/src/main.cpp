@@ -8,26 +8,288 @@
  * - 処理パイプラインの実行
  *
  * 使い方:
- * sign_compiler preprocess <入力ファイル> [--output <出力ファイル>]
+ * sign_compiler preprocess <入力ファイル> [--output <出力ファイル>] [--jobs <スレッド数>] [--cache-dir <ディレクトリ>]
+ *                          [--inline-* <値>] [--inline-report <ファイル>] [--stats] [--stats-json <ファイル>]
+ *                          [--trace-out <ファイル>]
+ * sign_compiler batch <入力>... [--output-dir <出力ディレクトリ>] [--jobs <スレッド数>] [--cache-dir <ディレクトリ>]
+ *                     [--trace-out <ファイル>]
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250427_0
+ * ver_20261016_9
  */
 
+#include "common/utils/output_sink.h"
+#include "common/utils/trace.h"
+#include "preprocessor/batch_processor.h"
+#include "preprocessor/preprocess_cache.h"
 #include "preprocessor/sign_transformer.h"
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <sstream>
 
 void printUsage()
 {
-    std::cout << "使い方: sign_compiler preprocess <入力ファイル> [--output <出力ファイル>]" << std::endl;
+    std::cout << "使い方: sign_compiler preprocess <入力ファイル> [--output <出力ファイル>] [--jobs <スレッド数>] [--cache-dir <ディレクトリ>]" << std::endl;
     std::cout << "オプション:" << std::endl;
-    std::cout << "  --output <ファイル>  処理結果を指定ファイルに出力" << std::endl;
+    std::cout << "  --output <ファイル>  処理結果を指定ファイルに出力（- なら標準出力）" << std::endl;
     std::cout << "  --dump               処理結果を標準出力に表示" << std::endl;
+    std::cout << "  --jobs <数>          ブロックを並列処理するスレッド数（0で全コア、既定は1）" << std::endl;
+    std::cout << "  --cache-dir <dir>    前処理結果をキャッシュするディレクトリ" << std::endl;
+    std::cout << "  --cache-max-mb <数>  キャッシュの容量上限（MB、既定は256）" << std::endl;
+    std::cout << "  --inline-max-tokens <数>        展開する定義の最大トークン数（既定は5）" << std::endl;
+    std::cout << "  --inline-single-use-tokens <数> 使用箇所が1つ以下の定義を展開する最大トークン数（既定は5）" << std::endl;
+    std::cout << "  --inline-lambdas                ラムダ式を含む定義も展開する" << std::endl;
+    std::cout << "  --inline-block-budget <数>      ブロックごとのトークン増加数の上限" << std::endl;
+    std::cout << "  --inline-budget <数>            全体のトークン増加数の上限" << std::endl;
+    std::cout << "  --inline-report <ファイル>      インライン展開の判断と実績をファイルに出力" << std::endl;
+    std::cout << "  --stats              段階ごとの処理時間・トークン数・メモリ確保量などを表示" << std::endl;
+    std::cout << "  --stats-json <ファイル>  同じ統計をJSON形式でファイルに出力（- なら標準出力、--output - とは併用不可）" << std::endl;
+    std::cout << "  --trace-out <ファイル>   段階・ブロック・スレッドごとの処理区間を Chrome trace 形式で出力" << std::endl;
+    std::cout << std::endl;
+    std::cout << "使い方: sign_compiler batch <入力>... [--output-dir <出力ディレクトリ>] [--jobs <スレッド数>] [--cache-dir <ディレクトリ>]" << std::endl;
+    std::cout << "  <入力>               ファイル、ディレクトリ（.sn を再帰的に検索）、@レスポンスファイル" << std::endl;
+    std::cout << "  --output-dir <dir>   出力ディレクトリ（省略時は入力ファイルと同じ場所）" << std::endl;
+    std::cout << "  --jobs <数>          ファイルとブロックを並列処理するスレッド数（既定は0で全コア）" << std::endl;
+    std::cout << "  --cache-dir, --cache-max-mb, --inline-*（--inline-report を除く）, --trace-out は preprocess と同じ" << std::endl;
+}
+
+// スレッド数などの非負整数の引数を解析する（不正な場合はfalse）
+bool parseCount(const char *text, size_t &count)
+{
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || text[0] == '-')
+    {
+        return false;
+    }
+    count = static_cast<size_t>(value);
+    return true;
+}
+
+// インライン展開の設定の引数を解析する
+// 戻り値は消費した引数の数（インライン展開の設定でなければ0、値が不正なら-1）
+int parseInlineOption(int argc, char *argv[], int i, sign::InlineOptions &inlining)
+{
+    if (std::strcmp(argv[i], "--inline-lambdas") == 0)
+    {
+        inlining.allowLambda = true;
+        return 1;
+    }
+
+    const std::pair<const char *, size_t *> countOptions[] = {
+        {"--inline-max-tokens", &inlining.maxTokens},
+        {"--inline-single-use-tokens", &inlining.maxSingleUseTokens},
+        {"--inline-block-budget", &inlining.blockBudget},
+        {"--inline-budget", &inlining.totalBudget},
+    };
+    for (const auto &[name, value] : countOptions)
+    {
+        if (std::strcmp(argv[i], name) == 0 && i + 1 < argc)
+        {
+            if (!parseCount(argv[i + 1], *value))
+            {
+                std::cout << "不正な値: " << argv[i] << " " << argv[i + 1] << std::endl;
+                return -1;
+            }
+            return 2;
+        }
+    }
+    return 0;
+}
+
+/**
+ * トレースの出力先を開き、記録を開始する（パスが空なら何もしない）
+ *
+ * @return 出力先を開けなかった場合はfalse
+ */
+bool startTrace(const std::string &path, std::ofstream &out)
+{
+    if (path.empty())
+    {
+        return true;
+    }
+    out.open(path);
+    if (!out.is_open())
+    {
+        std::cerr << "トレースファイルを開けませんでした: " << path << std::endl;
+        return false;
+    }
+    if (!sign::common::TRACING_AVAILABLE)
+    {
+        std::cerr << "このビルドではトレースを取れません（SIGN_NO_TRACE）" << std::endl;
+    }
+    sign::common::trace::setThreadName("main");
+    sign::common::trace::start();
+    return true;
+}
+
+// 記録を終了し、トレースを書き出す
+bool finishTrace(const std::string &path, std::ofstream &out)
+{
+    if (path.empty())
+    {
+        return true;
+    }
+    sign::common::trace::stop();
+    if (!sign::common::trace::writeChromeTrace(out))
+    {
+        std::cerr << "トレースファイルの書き込みに失敗しました: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// batch コマンド：複数のファイルを共有スレッドプールでまとめて処理する
+int runBatch(int argc, char *argv[])
+{
+    std::vector<std::string> arguments;
+    sign::BatchOptions options;
+    size_t jobs = 0;
+    std::string cacheDir;
+    size_t cacheMaxMegabytes = sign::PreprocessCache::DEFAULT_MAX_BYTES >> 20;
+    std::string traceFile;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc)
+        {
+            options.outputDir = argv[i + 1];
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            if (!parseCount(argv[i + 1], jobs))
+            {
+                std::cout << "不正なスレッド数: " << argv[i + 1] << std::endl;
+                printUsage();
+                return 1;
+            }
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc)
+        {
+            cacheDir = argv[i + 1];
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--cache-max-mb") == 0 && i + 1 < argc)
+        {
+            if (!parseCount(argv[i + 1], cacheMaxMegabytes))
+            {
+                std::cout << "不正なキャッシュ容量: " << argv[i + 1] << std::endl;
+                printUsage();
+                return 1;
+            }
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--trace-out") == 0 && i + 1 < argc)
+        {
+            traceFile = argv[i + 1];
+            i++; // 次の引数をスキップ
+        }
+        else if (int consumed = parseInlineOption(argc, argv, i, options.inlining))
+        {
+            if (consumed < 0)
+            {
+                printUsage();
+                return 1;
+            }
+            i += consumed - 1; // 値の引数をスキップ
+        }
+        else if (std::strncmp(argv[i], "--", 2) == 0)
+        {
+            std::cout << "不明なオプション: " << argv[i] << std::endl;
+            printUsage();
+            return 1;
+        }
+        else
+        {
+            arguments.push_back(argv[i]);
+        }
+    }
+
+    try
+    {
+        std::vector<std::string> skipped;
+        std::vector<std::string> inputs = sign::collectBatchInputs(arguments, &skipped);
+        for (const auto &file : skipped)
+        {
+            std::cout << "処理済みファイルを除外: " << file << std::endl;
+        }
+        if (inputs.empty())
+        {
+            std::cerr << "入力ファイルがありません" << std::endl;
+            return 1;
+        }
+
+        // キャッシュはプロセス内の全ファイルで共有する
+        std::unique_ptr<sign::PreprocessCache> cache;
+        if (!cacheDir.empty())
+        {
+            cache = std::make_unique<sign::PreprocessCache>(cacheDir, static_cast<std::uint64_t>(cacheMaxMegabytes) << 20);
+            options.cache = cache.get();
+        }
+
+        std::ofstream trace;
+        if (!startTrace(traceFile, trace))
+        {
+            return 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        sign::common::ThreadPool pool(jobs);
+        std::vector<sign::BatchFileResult> results = sign::processBatch(inputs, options, pool);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!finishTrace(traceFile, trace))
+        {
+            return 1;
+        }
+
+        // ファイルごとの結果（入力順）
+        size_t succeeded = 0;
+        size_t inputBytes = 0;
+        double fileSeconds = 0.0;
+        std::cout << std::fixed << std::setprecision(2);
+        for (const auto &result : results)
+        {
+            if (result.success)
+            {
+                ++succeeded;
+                inputBytes += result.inputBytes;
+                fileSeconds += result.seconds;
+                std::cout << "処理完了: " << result.inputPath << " -> " << result.outputPath
+                          << " (" << result.inputBytes << " bytes, " << result.seconds * 1e3 << " ms)" << std::endl;
+            }
+            else
+            {
+                std::cerr << "処理失敗: " << result.inputPath << ": " << result.error << std::endl;
+            }
+        }
+
+        // 全体の集計
+        std::cout << "合計: " << succeeded << "/" << results.size() << " ファイル, "
+                  << inputBytes << " bytes, " << seconds * 1e3 << " ms"
+                  << " (ファイル処理時間の合計 " << fileSeconds * 1e3 << " ms, "
+                  << pool.concurrency() << " スレッド";
+        if (seconds > 0.0)
+        {
+            std::cout << ", " << inputBytes / seconds / (1024.0 * 1024.0) << " MB/s";
+        }
+        std::cout << ")" << std::endl;
+
+        return succeeded == results.size() ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "エラーが発生しました: " << e.what() << std::endl;
+        return 1;
+    }
 }
 
 int main(int argc, char *argv[])
@@ -39,6 +301,12 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    // batch コマンド
+    if (std::strcmp(argv[1], "batch") == 0)
+    {
+        return runBatch(argc, argv);
+    }
+
     // 最初の引数がpreprocessかどうか確認
     if (std::strcmp(argv[1], "preprocess") != 0)
     {
@@ -53,6 +321,13 @@ int main(int argc, char *argv[])
     // オプションの解析
     std::string outputFile = inputFile + ".processed.sn"; // デフォルトの出力ファイル名
     bool dumpToConsole = false;
+    sign::PreprocessOptions options;
+    std::string cacheDir;
+    size_t cacheMaxMegabytes = sign::PreprocessCache::DEFAULT_MAX_BYTES >> 20;
+    std::string inlineReportFile;
+    bool showStats = false;
+    std::string statsJsonFile;
+    std::string traceFile;
 
     for (int i = 3; i < argc; i++)
     {
@@ -65,6 +340,59 @@ int main(int argc, char *argv[])
         {
             dumpToConsole = true;
         }
+        else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            if (!parseCount(argv[i + 1], options.jobs))
+            {
+                std::cout << "不正なスレッド数: " << argv[i + 1] << std::endl;
+                printUsage();
+                return 1;
+            }
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc)
+        {
+            cacheDir = argv[i + 1];
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--cache-max-mb") == 0 && i + 1 < argc)
+        {
+            if (!parseCount(argv[i + 1], cacheMaxMegabytes))
+            {
+                std::cout << "不正なキャッシュ容量: " << argv[i + 1] << std::endl;
+                printUsage();
+                return 1;
+            }
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--inline-report") == 0 && i + 1 < argc)
+        {
+            inlineReportFile = argv[i + 1];
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--stats") == 0)
+        {
+            showStats = true;
+        }
+        else if (std::strcmp(argv[i], "--stats-json") == 0 && i + 1 < argc)
+        {
+            statsJsonFile = argv[i + 1];
+            i++; // 次の引数をスキップ
+        }
+        else if (std::strcmp(argv[i], "--trace-out") == 0 && i + 1 < argc)
+        {
+            traceFile = argv[i + 1];
+            i++; // 次の引数をスキップ
+        }
+        else if (int consumed = parseInlineOption(argc, argv, i, options.inlining))
+        {
+            if (consumed < 0)
+            {
+                printUsage();
+                return 1;
+            }
+            i += consumed - 1; // 値の引数をスキップ
+        }
         else
         {
             std::cout << "不明なオプション: " << argv[i] << std::endl;
@@ -73,10 +401,22 @@ int main(int argc, char *argv[])
         }
     }
 
+    // 処理結果と統計のJSONを両方とも標準出力に書き出すと混ざるため、同時には指定できない
+    if (outputFile == "-" && statsJsonFile == "-")
+    {
+        std::cout << "--output - と --stats-json - は同時に指定できません" << std::endl;
+        printUsage();
+        return 1;
+    }
+
     try
     {
+        // 標準出力に結果を書き出す場合、進行状況は標準エラー出力に表示する
+        const bool outputToConsole = (outputFile == "-");
+        std::ostream &status = outputToConsole ? std::cerr : std::cout;
+
         // プリプロセッサの実行
-        std::cout << "ファイル処理中: " << inputFile << std::endl;
+        status << "ファイル処理中: " << inputFile << std::endl;
 
         // ファイルを読み込んで処理
         std::ifstream inFile(inputFile);
@@ -91,28 +431,106 @@ int main(int argc, char *argv[])
         buffer << inFile.rdbuf();
         inFile.close();
 
-        // ソースコードを処理
-        std::string sourceCode = buffer.str();
-        std::string processedCode = sign::preprocessSourceCode(sourceCode);
+        // キャッシュを開く
+        std::unique_ptr<sign::PreprocessCache> cache;
+        if (!cacheDir.empty())
+        {
+            cache = std::make_unique<sign::PreprocessCache>(cacheDir, static_cast<std::uint64_t>(cacheMaxMegabytes) << 20);
+            options.cache = cache.get();
+        }
 
-        // 結果をファイルに書き込む
-        if (!sign::writeToFile(processedCode, outputFile))
+        // インライン展開のレポートの出力先を開く
+        std::ofstream inlineReport;
+        if (!inlineReportFile.empty())
         {
-            std::cerr << "出力ファイルの書き込みに失敗しました: " << outputFile << std::endl;
-            return 1;
+            inlineReport.open(inlineReportFile);
+            if (!inlineReport.is_open())
+            {
+                std::cerr << "レポートファイルを開けませんでした: " << inlineReportFile << std::endl;
+                return 1;
+            }
+            options.inlineReport = &inlineReport;
         }
 
-        std::cout << "処理完了: " << outputFile << std::endl;
+        // 統計の記録先と、JSONの出力先を開く
+        sign::PreprocessStats stats;
+        std::ofstream statsJson;
+        if ((showStats || !statsJsonFile.empty()) && !sign::STATS_AVAILABLE)
+        {
+            std::cerr << "このビルドでは統計を取れません（SIGN_NO_STATS）" << std::endl;
+            showStats = false;
+            statsJsonFile.clear();
+        }
+        if (showStats || !statsJsonFile.empty())
+        {
+            options.stats = &stats;
+        }
+        if (!statsJsonFile.empty() && statsJsonFile != "-")
+        {
+            statsJson.open(statsJsonFile);
+            if (!statsJson.is_open())
+            {
+                std::cerr << "統計ファイルを開けませんでした: " << statsJsonFile << std::endl;
+                return 1;
+            }
+        }
 
-        // 結果を標準出力に表示
-        if (dumpToConsole)
+        // 出力先を開く（--dump 指定時は標準出力にも同時に書き出す）
+        sign::common::FileSink outputSink(outputFile);
+        if (!outputSink.isOpen())
+        {
+            std::cerr << "出力ファイルを開けませんでした: " << outputFile << std::endl;
+            return 1;
+        }
+        const bool dump = dumpToConsole && !outputToConsole;
+        sign::common::FileSink consoleSink("-");
+        sign::common::TeeSink teeSink(outputSink, consoleSink);
+        sign::common::OutputSink &sink = dump ? static_cast<sign::common::OutputSink &>(teeSink) : outputSink;
+        if (dump)
         {
             std::cout << "\n===== 処理結果 =====\n"
                       << std::endl;
-            std::cout << processedCode << std::endl;
+        }
+
+        // トレースの記録を開始する
+        std::ofstream trace;
+        if (!startTrace(traceFile, trace))
+        {
+            return 1;
+        }
+
+        // ソースコードを処理し、ブロックごとに書き出す
+        std::string sourceCode = buffer.str();
+        bool written = sign::preprocessSourceCode(sourceCode, sink, options);
+        written = outputSink.close() && written;
+        if (!finishTrace(traceFile, trace))
+        {
+            return 1;
+        }
+        if (dump)
+        {
+            consoleSink.flush();
+            std::cout << std::endl;
             std::cout << "\n====================" << std::endl;
         }
 
+        if (!written)
+        {
+            std::cerr << "出力ファイルの書き込みに失敗しました: " << outputFile << std::endl;
+            return 1;
+        }
+
+        status << "処理完了: " << outputFile << std::endl;
+
+        if (showStats)
+        {
+            sign::writeStatsText(status, stats);
+        }
+        if (!statsJsonFile.empty())
+        {
+            sign::writeStatsJson(statsJsonFile == "-" ? std::cout : statsJson, stats);
+        }
+
         return 0;
     }
     catch (const std::exception &e)
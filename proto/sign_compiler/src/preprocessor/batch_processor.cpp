@@ -0,0 +1,210 @@
+// src/preprocessor/batch_processor.cpp
+/**
+ * 複数のSign言語ファイルをまとめて前処理する実装
+ *
+ * ver_20261016_5
+ */
+
+#include "preprocessor/batch_processor.h"
+#include "preprocessor/sign_transformer.h"
+#include "common/utils/file_utils.h"
+#include "common/utils/output_sink.h"
+#include "common/utils/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace sign
+{
+
+    namespace fs = std::filesystem;
+
+    // 処理済みファイルかどうか
+    // preprocess の既定の出力（<入力>.processed.sn）と、run-test.bat の出力（<名前>_processed.sn）のみ
+    static bool isProcessedFile(const std::string &filename)
+    {
+        for (const std::string suffix : {".processed.sn", "_processed.sn"})
+        {
+            if (filename.size() >= suffix.size() &&
+                filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 入力指定を1件展開して追加する
+    static void collectInput(const std::string &argument,
+                             std::vector<std::string> &inputs,
+                             std::unordered_set<std::string> &seen,
+                             std::vector<std::string> *skipped,
+                             size_t depth)
+    {
+        auto add = [&](const std::string &path)
+        {
+            if (seen.insert(fs::path(path).lexically_normal().string()).second)
+            {
+                inputs.push_back(path);
+            }
+        };
+
+        // レスポンスファイル（1行に1項目、空行は無視）
+        if (!argument.empty() && argument[0] == '@')
+        {
+            if (depth > 8)
+            {
+                throw std::runtime_error("レスポンスファイルの入れ子が深すぎます: " + argument);
+            }
+            std::ifstream file(argument.substr(1));
+            if (!file.is_open())
+            {
+                throw std::runtime_error("レスポンスファイルを開けませんでした: " + argument.substr(1));
+            }
+            std::string line;
+            while (std::getline(file, line))
+            {
+                while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+                {
+                    line.pop_back();
+                }
+                if (!line.empty())
+                {
+                    collectInput(line, inputs, seen, skipped, depth + 1);
+                }
+            }
+            return;
+        }
+
+        // ディレクトリは再帰的に走査し、名前順に追加
+        if (fs::is_directory(argument))
+        {
+            std::vector<std::string> files;
+            std::vector<std::string> processed;
+            for (const auto &entry : fs::recursive_directory_iterator(argument))
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".sn")
+                {
+                    (isProcessedFile(entry.path().filename().string()) ? processed : files).push_back(entry.path().string());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            if (skipped != nullptr)
+            {
+                std::sort(processed.begin(), processed.end());
+                skipped->insert(skipped->end(), processed.begin(), processed.end());
+            }
+            for (const auto &file : files)
+            {
+                add(file);
+            }
+            return;
+        }
+
+        if (!fs::is_regular_file(argument))
+        {
+            throw std::runtime_error("入力ファイルが見つかりません: " + argument);
+        }
+        add(argument);
+    }
+
+    std::vector<std::string> collectBatchInputs(const std::vector<std::string> &arguments,
+                                                std::vector<std::string> *skipped)
+    {
+        std::vector<std::string> inputs;
+        std::unordered_set<std::string> seen;
+        for (const auto &argument : arguments)
+        {
+            collectInput(argument, inputs, seen, skipped, 0);
+        }
+        return inputs;
+    }
+
+    std::string batchOutputPath(const std::string &inputPath, const BatchOptions &options)
+    {
+        if (options.outputDir.empty())
+        {
+            return inputPath + ".processed.sn";
+        }
+        return (fs::path(options.outputDir) / (fs::path(inputPath).filename().string() + ".processed.sn")).string();
+    }
+
+    std::vector<BatchFileResult> processBatch(const std::vector<std::string> &inputs,
+                                              const BatchOptions &options,
+                                              common::ThreadPool &pool)
+    {
+        std::vector<BatchFileResult> results(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            results[i].inputPath = inputs[i];
+            results[i].outputPath = batchOutputPath(inputs[i], options);
+        }
+
+        // 出力先が重なる入力（別ディレクトリの同名ファイル）は処理しない
+        std::unordered_set<std::string> outputs;
+        for (auto &result : results)
+        {
+            if (!outputs.insert(fs::path(result.outputPath).lexically_normal().string()).second)
+            {
+                result.error = "出力ファイルが他の入力と重複しています: " + result.outputPath;
+            }
+        }
+
+        if (!options.outputDir.empty())
+        {
+            std::error_code ec;
+            fs::create_directories(options.outputDir, ec);
+            if (ec)
+            {
+                throw std::runtime_error("出力ディレクトリを作成できませんでした: " + options.outputDir);
+            }
+        }
+
+        // ファイル単位で並列に処理（各ファイルのブロック処理も同じプールで実行）
+        PreprocessOptions preprocessOptions;
+        preprocessOptions.pool = &pool;
+        preprocessOptions.cache = options.cache;
+        preprocessOptions.inlining = options.inlining;
+        pool.parallelFor(results.size(), [&](size_t i)
+                         {
+                             BatchFileResult &result = results[i];
+                             if (!result.error.empty())
+                             {
+                                 return;
+                             }
+
+                             common::TraceSpan span("file", result.inputPath);
+                             const auto start = std::chrono::steady_clock::now();
+                             try
+                             {
+                                 const std::string sourceCode = common::readFromFile(result.inputPath);
+                                 result.inputBytes = sourceCode.size();
+
+                                 // 出力はブロックごとに書き出す
+                                 common::FileSink output(result.outputPath);
+                                 bool written = output.isOpen() && preprocessSourceCode(sourceCode, output, preprocessOptions);
+                                 written = output.close() && written;
+                                 result.outputBytes = output.bytesWritten();
+                                 if (written)
+                                 {
+                                     result.success = true;
+                                 }
+                                 else
+                                 {
+                                     result.error = "出力ファイルの書き込みに失敗しました: " + result.outputPath;
+                                 }
+                             }
+                             catch (const std::exception &e)
+                             {
+                                 result.error = e.what();
+                             }
+                             result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); },
+                         1);
+
+        return results;
+    }
+
+} // namespace sign
@@ -0,0 +1,85 @@
+// src/preprocessor/batch_processor.h
+/**
+ * 複数のSign言語ファイルを1回の起動でまとめて前処理するモジュール
+ *
+ * 機能:
+ * - 入力の展開（ファイル、ディレクトリ内の .sn ファイル、@レスポンスファイル）
+ * - 共有スレッドプールによるファイル単位・ブロック単位の並列処理
+ * - ファイルごとの処理時間と結果の記録
+ *
+ * ver_20261016_3
+ */
+
+#ifndef SIGN_BATCH_PROCESSOR_H
+#define SIGN_BATCH_PROCESSOR_H
+
+#include "common/utils/thread_pool.h"
+#include "preprocessor/inliner.h"
+#include <string>
+#include <vector>
+
+namespace sign
+{
+
+    // バッチ処理のオプション
+    class PreprocessCache;
+
+    struct BatchOptions
+    {
+        std::string outputDir;                  // 出力ディレクトリ（空なら入力ファイルと同じ場所）
+        const PreprocessCache *cache = nullptr; // 結果のディスクキャッシュ（任意）
+        InlineOptions inlining;                 // インライン展開の設定
+    };
+
+    // ファイル1件の処理結果
+    struct BatchFileResult
+    {
+        std::string inputPath;  // 入力ファイル
+        std::string outputPath; // 出力ファイル
+        size_t inputBytes = 0;  // 入力サイズ
+        size_t outputBytes = 0; // 出力サイズ
+        double seconds = 0.0;   // 読み込みから書き込みまでの処理時間
+        bool success = false;   // 成功した場合はtrue
+        std::string error;      // 失敗時のエラーメッセージ
+    };
+
+    /**
+     * コマンドラインの入力指定を入力ファイルの一覧に展開する
+     * - ディレクトリは再帰的に走査し、.sn ファイル（処理済みファイルを除く）を名前順に追加
+     * - @<ファイル> はレスポンスファイルとして1行1項目で読み込み、各行を同様に展開
+     * 処理済みファイルは名前が .processed.sn か _processed.sn で終わるもの（直接指定したファイルは除外しない）
+     *
+     * @param arguments 入力指定
+     * @param skipped ディレクトリの走査で除外した処理済みファイルの記録先（nullptrなら記録しない）
+     * @return 入力ファイルの一覧（指定順、重複なし）
+     * @throws std::runtime_error 入力が存在しない場合
+     */
+    std::vector<std::string> collectBatchInputs(const std::vector<std::string> &arguments,
+                                                std::vector<std::string> *skipped = nullptr);
+
+    /**
+     * 入力ファイルに対応する出力ファイルのパスを返す
+     * preprocess コマンドと同じく <入力ファイル名>.processed.sn とする
+     *
+     * @param inputPath 入力ファイル
+     * @param options バッチ処理のオプション
+     * @return 出力ファイルのパス
+     */
+    std::string batchOutputPath(const std::string &inputPath, const BatchOptions &options);
+
+    /**
+     * 複数のファイルを共有スレッドプールで前処理する
+     * ファイル単位の処理とファイル内のブロック単位の処理が同じプールで実行される
+     *
+     * @param inputs 入力ファイルの一覧
+     * @param options バッチ処理のオプション
+     * @param pool 共有スレッドプール
+     * @return ファイルごとの処理結果（入力と同じ順序）
+     */
+    std::vector<BatchFileResult> processBatch(const std::vector<std::string> &inputs,
+                                              const BatchOptions &options,
+                                              common::ThreadPool &pool);
+
+} // namespace sign
+
+#endif // SIGN_BATCH_PROCESSOR_H
@@ -0,0 +1,326 @@
+// src/preprocessor/incremental_preprocessor.cpp
+/**
+ * 差分プリプロセスのセッションの実装
+ *
+ * 更新の手順:
+ * 1. 正規化してブロックに分割し、内容ハッシュで前回のブロックと対応付ける
+ * 2. 新しいブロックのみ字句解析・ラムダ式・部分適用・定義抽出を行う
+ * 3. 有効な定義の提供元が変わった場合のみ定義を解決し直し、展開結果が変わった定義を求める
+ * 4. 新しいブロックと、展開結果が変わった定義を参照するブロックのみ定義を適用し直す
+ *
+ * 参照しているかどうかは、ブロックごとに保持する参照位置の索引で調べる（参照の検索にも使う）
+ *
+ * ver_20261016_5
+ */
+
+#include "preprocessor/incremental_preprocessor.h"
+#include "preprocessor/occurrence_index.h"
+#include "common/parser/source_normalizer.h"
+#include "common/utils/hash.h"
+#include <unordered_set>
+
+namespace sign
+{
+
+    // ブロック1つ分の保持データ
+    struct IncrementalPreprocessor::BlockState
+    {
+        std::uint64_t hash = 0;                    // 正規化済みテキストのハッシュ
+        std::unique_ptr<const std::string> text;   // 正規化済みテキスト（トークンはこれを参照する）
+        std::vector<common::Token> tokens;         // ラムダ式と部分適用を処理したトークン列
+        BlockDefinitions definitions;              // 抽出した定義
+        OccurrenceIndex occurrences;               // 識別子の参照位置の索引
+        std::string output;                        // 定義を適用した処理結果
+    };
+
+    // 2つのトークン列が同じ内容か
+    static bool sameTokens(const std::vector<common::Token> &a, const std::vector<common::Token> &b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].type() != b[i].type() || a[i].value() != b[i].value())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    IncrementalPreprocessor::IncrementalPreprocessor(const PreprocessOptions &options)
+        : resolved(resolveDefinitions(DefinitionTable()))
+    {
+        pool = options.pool;
+        if (pool == nullptr && options.jobs != 1)
+        {
+            ownedPool = std::make_unique<common::ThreadPool>(options.jobs);
+            pool = ownedPool.get();
+        }
+
+        // rebuild で戻す位置（プリプロセッサが保持し続けるIDは先に登録しておく）
+        internWellKnownSymbols();
+        symbolMark = common::globalSymbols().size();
+        synthesizedMark = common::Token::synthesizedCount();
+    }
+
+    IncrementalPreprocessor::~IncrementalPreprocessor() = default;
+
+    IncrementalUpdate IncrementalPreprocessor::update(const std::string &sourceCode)
+    {
+        using namespace common;
+
+        IncrementalUpdate result;
+        NormalizedSource normalized = normalizeSource(sourceCode);
+
+        // ステップ1: 内容ハッシュで前回のブロックと対応付ける
+        std::unordered_multimap<std::uint64_t, size_t> previousByHash;
+        previousByHash.reserve(blocks.size());
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            previousByHash.emplace(blocks[i]->hash, i);
+        }
+
+        std::vector<std::unique_ptr<BlockState>> nextBlocks(normalized.blocks.size());
+        std::vector<size_t> freshBlocks;
+        for (size_t i = 0; i < normalized.blocks.size(); ++i)
+        {
+            const BlockSpan &span = normalized.blocks[i];
+            const std::string_view text(normalized.code.data() + span.offset, span.length);
+            const std::uint64_t hash = hashBytes(text);
+
+            auto range = previousByHash.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (*blocks[it->second]->text == text)
+                {
+                    nextBlocks[i] = std::move(blocks[it->second]);
+                    previousByHash.erase(it);
+                    break;
+                }
+            }
+
+            if (!nextBlocks[i])
+            {
+                nextBlocks[i] = std::make_unique<BlockState>();
+                nextBlocks[i]->hash = hash;
+                nextBlocks[i]->text = std::make_unique<const std::string>(text);
+                freshBlocks.push_back(i);
+            }
+        }
+
+        // 対応するブロックがなかった前回のブロックは、古い定義が参照しているため更新の最後まで保持する
+        std::vector<std::unique_ptr<BlockState>> retiredBlocks = std::move(blocks);
+        blocks = std::move(nextBlocks);
+
+        // ステップ2: 新しいブロックのみ前半の処理を行う
+        ThreadPool::parallelFor(pool, freshBlocks.size(), [&](size_t k)
+                                {
+                                    BlockState &block = *blocks[freshBlocks[k]];
+                                    TokenStream tokens = tokenizeStream(*block.text);
+                                    TokenStream processed = processPartialApplications(processLambdaExpressions(std::move(tokens)));
+                                    block.definitions = extractBlockDefinitions(processed);
+                                    block.tokens = processed.release();
+                                    block.occurrences = OccurrenceIndex(block.tokens); });
+
+        // ステップ3: 有効な定義の提供元を求め、前回から変わった識別子を検出する
+        // （extractDefinitions と同じく後のブロック・後の定義が優先）
+        std::unordered_map<SymbolId, DefinitionSource> nextSources;
+        for (const auto &block : blocks)
+        {
+            for (size_t d = 0; d < block->definitions.size(); ++d)
+            {
+                nextSources[block->definitions[d].first] = DefinitionSource{block.get(), d};
+            }
+        }
+
+        bool sourcesChanged = nextSources.size() != definitionSources.size();
+        for (auto it = nextSources.begin(); !sourcesChanged && it != nextSources.end(); ++it)
+        {
+            auto previous = definitionSources.find(it->first);
+            sourcesChanged = previous == definitionSources.end() || !(previous->second == it->second);
+        }
+
+        std::unordered_set<SymbolId> changedDefinitions;
+        if (sourcesChanged)
+        {
+            DefinitionTable table;
+            table.reserve(nextSources.size());
+            for (const auto &[name, source] : nextSources)
+            {
+                table.emplace(name, source.block->definitions[source.index].second);
+            }
+            std::shared_ptr<const ResolvedDefinitions> nextResolved = resolveDefinitions(table);
+
+            // 展開結果が変わった定義
+            for (const auto &[name, entry] : *nextResolved)
+            {
+                const ResolvedDefinition *previous = resolved->find(name);
+                if (previous == nullptr || previous->inlinable != entry.inlinable || !sameTokens(previous->tokens, entry.tokens))
+                {
+                    changedDefinitions.insert(name);
+                }
+            }
+            for (const auto &[name, entry] : *resolved)
+            {
+                if (nextResolved->find(name) == nullptr)
+                {
+                    changedDefinitions.insert(name);
+                }
+            }
+
+            // 解決せずに残した循環する定義は、適用時に本体の識別子を展開するため、参照先の変更の影響も受ける
+            // （解決済みの定義の変更は、解決済みの展開結果か inlinable の変化として現れる）
+            std::unordered_map<SymbolId, std::vector<SymbolId>> referencedBy;
+            for (const auto &[name, entry] : *nextResolved)
+            {
+                if (!entry.circular)
+                {
+                    continue;
+                }
+                for (const auto &token : entry.tokens)
+                {
+                    if (token.type() == TokenType::IDENTIFIER && token.symbol != name)
+                    {
+                        referencedBy[token.symbol].push_back(name);
+                    }
+                }
+            }
+            std::vector<SymbolId> worklist(changedDefinitions.begin(), changedDefinitions.end());
+            while (!worklist.empty())
+            {
+                const SymbolId name = worklist.back();
+                worklist.pop_back();
+                auto users = referencedBy.find(name);
+                if (users == referencedBy.end())
+                {
+                    continue;
+                }
+                for (SymbolId user : users->second)
+                {
+                    if (changedDefinitions.insert(user).second)
+                    {
+                        worklist.push_back(user);
+                    }
+                }
+            }
+
+            resolved = std::move(nextResolved);
+            definitionSources = std::move(nextSources);
+        }
+        result.changedDefinitions = changedDefinitions.size();
+
+        // ステップ4: 定義を適用し直すブロックを求める
+        std::vector<bool> dirty(blocks.size(), false);
+        for (size_t i : freshBlocks)
+        {
+            dirty[i] = true;
+        }
+        if (!changedDefinitions.empty())
+        {
+            for (size_t i = 0; i < blocks.size(); ++i)
+            {
+                if (dirty[i])
+                {
+                    continue;
+                }
+                for (SymbolId symbol : changedDefinitions)
+                {
+                    if (blocks[i]->occurrences.contains(symbol))
+                    {
+                        dirty[i] = true;
+                        ++result.reappliedBlocks;
+                        break;
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            if (dirty[i])
+            {
+                result.changedBlocks.push_back(i);
+            }
+        }
+
+        ThreadPool::parallelFor(pool, result.changedBlocks.size(), [&](size_t k)
+                                {
+                                    BlockState &block = *blocks[result.changedBlocks[k]];
+                                    block.output.clear();
+                                    appendTokens(block.output, applyDefinitions(block.tokens, *resolved)); });
+
+        result.reprocessedBlocks = freshBlocks.size();
+        result.reusedBlocks = blocks.size() - freshBlocks.size();
+        return result;
+    }
+
+    IncrementalUpdate IncrementalPreprocessor::rebuild(const std::string &sourceCode)
+    {
+        // トークンと定義は破棄する識別子・合成トークンの値を参照しているため、先に手放す
+        blocks.clear();
+        definitionSources.clear();
+        resolved = resolveDefinitions(DefinitionTable());
+
+        common::globalSymbols().truncate(symbolMark);
+        common::Token::truncateSynthesized(synthesizedMark);
+
+        return update(sourceCode);
+    }
+
+    std::string_view IncrementalPreprocessor::blockSource(size_t index) const
+    {
+        return *blocks.at(index)->text;
+    }
+
+    const std::vector<common::Token> &IncrementalPreprocessor::blockTokens(size_t index) const
+    {
+        return blocks.at(index)->tokens;
+    }
+
+    const BlockDefinitions &IncrementalPreprocessor::blockDefinitions(size_t index) const
+    {
+        return blocks.at(index)->definitions;
+    }
+
+    std::vector<SymbolReference> IncrementalPreprocessor::findReferences(common::SymbolId name) const
+    {
+        std::vector<SymbolReference> references;
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            for (size_t position : blocks[i]->occurrences.references(name))
+            {
+                references.push_back(SymbolReference{i, position});
+            }
+        }
+        return references;
+    }
+
+    const std::string &IncrementalPreprocessor::blockOutput(size_t index) const
+    {
+        return blocks.at(index)->output;
+    }
+
+    std::string IncrementalPreprocessor::output() const
+    {
+        size_t length = blocks.size();
+        for (const auto &block : blocks)
+        {
+            length += block->output.size();
+        }
+
+        std::string result;
+        result.reserve(length);
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            if (i > 0)
+            {
+                result += '\n'; // ブロック間に空行を挿入
+            }
+            result += blocks[i]->output;
+        }
+        return result;
+    }
+
+} // namespace sign
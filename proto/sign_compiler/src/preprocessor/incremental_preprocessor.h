@@ -0,0 +1,147 @@
+// src/preprocessor/incremental_preprocessor.h
+/**
+ * エディタ連携向けの差分プリプロセスを提供するモジュール
+ *
+ * 機能:
+ * - ブロックごとの内容ハッシュ・トークン列・抽出した定義の保持
+ * - ソース変更時に、内容が変わったブロックと変わった定義に依存するブロックのみ再処理
+ * - preprocessSourceCode と同一の出力
+ * - 識別子の参照の検索（ブロックごとの参照位置の索引を使う）
+ * - 長時間のセッションで増え続ける識別子と合成トークンの値の破棄（rebuild）
+ *
+ * ver_20261016_2
+ */
+
+#ifndef SIGN_INCREMENTAL_PREPROCESSOR_H
+#define SIGN_INCREMENTAL_PREPROCESSOR_H
+
+#include "preprocessor/lambda_processor.h"
+#include "preprocessor/sign_transformer.h"
+#include "common/utils/thread_pool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sign
+{
+
+    // 差分更新1回分の結果
+    struct IncrementalUpdate
+    {
+        size_t reusedBlocks = 0;           // 内容が変わらず処理結果を再利用したブロック数
+        size_t reprocessedBlocks = 0;      // 新規・変更されたため字句解析からやり直したブロック数
+        size_t reappliedBlocks = 0;        // 定義の変更の影響で定義の適用のみやり直したブロック数
+        size_t changedDefinitions = 0;     // 展開結果が変わった定義の数
+        std::vector<size_t> changedBlocks; // 出力を作り直したブロックの番号（更新後の並び、昇順）
+    };
+
+    // 識別子の参照1件
+    struct SymbolReference
+    {
+        size_t block;    // ブロックの番号
+        size_t position; // ブロックのトークン列（blockTokens）での位置
+    };
+
+    /**
+     * 差分プリプロセスのセッション
+     * ブロックの境界は extractCodeBlocks と同じ（正規化済みコード上のブロック）
+     */
+    class IncrementalPreprocessor
+    {
+    public:
+        /**
+         * セッションを生成する
+         *
+         * @param options 実行オプション（pool/jobs は再処理するブロックの並列実行に使う）
+         */
+        explicit IncrementalPreprocessor(const PreprocessOptions &options = PreprocessOptions());
+        ~IncrementalPreprocessor();
+
+        IncrementalPreprocessor(const IncrementalPreprocessor &) = delete;
+        IncrementalPreprocessor &operator=(const IncrementalPreprocessor &) = delete;
+
+        /**
+         * ソースコード全体を与えて処理結果を更新する
+         * 前回と同じ内容のブロックは再処理しない
+         *
+         * @param sourceCode 新しいソースコード
+         * @return 更新の結果
+         */
+        IncrementalUpdate update(const std::string &sourceCode);
+
+        /**
+         * 保持しているブロックをすべて破棄し、セッション生成後に登録された識別子と合成トークンの値を
+         * シンボルテーブルから取り除いてから、ソースコード全体を処理し直す
+         * 編集のたびに登録される識別子（入力途中の名前など）は update では解放されないため、
+         * 長時間動作するホストは登録数（globalSymbols().size()）が増えた時点で呼ぶ。
+         * 呼び出し中は、他のセッションやコンパイルが同じプロセスで動作していないこと
+         * （他で保持しているトークンや識別子IDは使用できなくなる）
+         *
+         * @param sourceCode 新しいソースコード
+         * @return 更新の結果（すべてのブロックを処理し直す）
+         */
+        IncrementalUpdate rebuild(const std::string &sourceCode);
+
+        // ブロックの数
+        size_t blockCount() const { return blocks.size(); }
+
+        // 正規化済みのブロックのテキスト
+        std::string_view blockSource(size_t index) const;
+
+        // ラムダ式と部分適用を処理したブロックのトークン列
+        const std::vector<common::Token> &blockTokens(size_t index) const;
+
+        // ブロックから抽出した定義
+        const BlockDefinitions &blockDefinitions(size_t index) const;
+
+        // ブロックの処理結果
+        const std::string &blockOutput(size_t index) const;
+
+        /**
+         * 識別子を参照している位置をすべて返す（定義文の左辺は含まない）
+         *
+         * @param name 識別子のID
+         * @return 参照の位置（ブロック順、ブロック内では出現順）
+         */
+        std::vector<SymbolReference> findReferences(common::SymbolId name) const;
+
+        // 解決済みの定義
+        const ResolvedDefinitions &definitions() const { return *resolved; }
+
+        /**
+         * ファイル全体の処理結果を返す（preprocessSourceCode と同一）
+         *
+         * @return 処理済みのコード
+         */
+        std::string output() const;
+
+    private:
+        struct BlockState;
+
+        // 定義を提供しているブロックと、ブロック内の定義の位置
+        struct DefinitionSource
+        {
+            const BlockState *block;
+            size_t index;
+
+            bool operator==(const DefinitionSource &other) const
+            {
+                return block == other.block && index == other.index;
+            }
+        };
+
+        std::vector<std::unique_ptr<BlockState>> blocks;
+        std::unordered_map<common::SymbolId, DefinitionSource> definitionSources; // 有効な定義の提供元
+        std::shared_ptr<const ResolvedDefinitions> resolved;
+        std::unique_ptr<common::ThreadPool> ownedPool;
+        common::ThreadPool *pool = nullptr;
+        size_t symbolMark = 0;      // セッション生成時の識別子の登録数
+        size_t synthesizedMark = 0; // セッション生成時の合成トークンの値の登録数
+    };
+
+} // namespace sign
+
+#endif // SIGN_INCREMENTAL_PREPROCESSOR_H
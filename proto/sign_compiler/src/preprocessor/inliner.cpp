@@ -0,0 +1,483 @@
+// src/preprocessor/inliner.cpp
+/**
+ * コストモデルに基づく定義のインライン展開の実装
+ *
+ * ver_20261016_6
+ */
+
+#include "preprocessor/inliner.h"
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace sign
+{
+
+    bool InlineOptions::isDefault() const
+    {
+        const InlineOptions defaults;
+        return maxTokens == defaults.maxTokens && maxSingleUseTokens == defaults.maxSingleUseTokens &&
+               allowLambda == defaults.allowLambda &&
+               blockBudget == defaults.blockBudget && totalBudget == defaults.totalBudget;
+    }
+
+    const char *inlineVerdictName(InlineVerdict verdict)
+    {
+        switch (verdict)
+        {
+        case InlineVerdict::INLINE:
+            return "inline";
+        case InlineVerdict::CIRCULAR:
+            return "circular";
+        case InlineVerdict::CONTAINS_LAMBDA:
+            return "lambda";
+        case InlineVerdict::NOT_BRACKETED:
+            return "not-bracketed";
+        case InlineVerdict::TOO_LARGE:
+            return "too-large";
+        case InlineVerdict::OVER_BUDGET:
+            return "over-budget";
+        }
+        return "unknown";
+    }
+
+    InlineVerdict evaluateInlineCandidate(const ResolvedDefinition &definition, size_t uses, const InlineOptions &options)
+    {
+        if (definition.containsLambda && !options.allowLambda)
+        {
+            return InlineVerdict::CONTAINS_LAMBDA;
+        }
+
+        // 括弧で始まる定義のみ展開する（[+]、[+ 1] など）
+        if (definition.tokens.empty() || definition.tokens.front().type() != common::TokenType::BRACKET_OPEN)
+        {
+            return InlineVerdict::NOT_BRACKETED;
+        }
+
+        // 使用箇所が1つ以下なら展開してもコードはほとんど増えないので、より大きな定義まで許す
+        const size_t limit = (uses <= 1) ? std::max(options.maxTokens, options.maxSingleUseTokens) : options.maxTokens;
+        if (definition.tokens.size() > limit)
+        {
+            return InlineVerdict::TOO_LARGE;
+        }
+
+        return InlineVerdict::INLINE;
+    }
+
+    // 展開対象になりうる位置の識別子か（定義文の左辺と演算子付きの識別子は展開しない）
+    static bool isInlineSite(const std::vector<common::Token> &tokens, size_t i)
+    {
+        using common::TokenType;
+
+        const common::Token &token = tokens[i];
+        return token.type() == TokenType::IDENTIFIER &&
+               !(i + 1 < tokens.size() && tokens[i + 1].type() == TokenType::DEFINE) &&
+               token.prefixLength() == 0 && token.postfixLength() == 0;
+    }
+
+    // 展開する循環する定義の間の参照のグラフの強連結成分を反復版のTarjan法で求め、
+    // 2つ以上の定義からなる成分（と自身を参照する定義）を返す
+    std::vector<common::SymbolId> findRecursiveInlines(const ResolvedDefinitions &definitions,
+                                                       const std::vector<common::SymbolId> &candidates)
+    {
+        using namespace common;
+        constexpr std::uint32_t UNVISITED = UINT32_MAX;
+
+        const std::uint32_t count = static_cast<std::uint32_t>(candidates.size());
+        std::unordered_map<SymbolId, std::uint32_t> nodeOf;
+        nodeOf.reserve(count);
+        for (std::uint32_t node = 0; node < count; ++node)
+        {
+            nodeOf.emplace(candidates[node], node);
+        }
+
+        // 本体の展開する位置から、展開する循環する定義への辺を張る
+        std::vector<size_t> edgeStart(count + 1, 0);
+        std::vector<std::uint32_t> edges;
+        std::vector<bool> selfLoop(count, false);
+        for (std::uint32_t node = 0; node < count; ++node)
+        {
+            edgeStart[node] = edges.size();
+            const std::vector<Token> &tokens = definitions.find(candidates[node])->tokens;
+            for (size_t i = 0; i < tokens.size(); ++i)
+            {
+                if (!isInlineSite(tokens, i))
+                {
+                    continue;
+                }
+                auto it = nodeOf.find(tokens[i].symbol);
+                if (it != nodeOf.end())
+                {
+                    selfLoop[node] = selfLoop[node] || it->second == node;
+                    edges.push_back(it->second);
+                }
+            }
+        }
+        edgeStart[count] = edges.size();
+
+        std::vector<std::uint32_t> order(count, UNVISITED); // 訪問順
+        std::vector<std::uint32_t> lowlink(count, 0);
+        std::vector<bool> onStack(count, false);
+        std::vector<std::uint32_t> sccStack;
+        std::vector<std::pair<std::uint32_t, size_t>> callStack; // (定義, 次に調べる辺)
+        std::uint32_t nextOrder = 0;
+        std::vector<SymbolId> recursive;
+
+        for (std::uint32_t root = 0; root < count; ++root)
+        {
+            if (order[root] != UNVISITED)
+            {
+                continue;
+            }
+
+            order[root] = lowlink[root] = nextOrder++;
+            sccStack.push_back(root);
+            onStack[root] = true;
+            callStack.push_back({root, edgeStart[root]});
+
+            while (!callStack.empty())
+            {
+                auto &[node, edge] = callStack.back();
+                if (edge < edgeStart[node + 1])
+                {
+                    const std::uint32_t dep = edges[edge++];
+                    if (order[dep] == UNVISITED)
+                    {
+                        order[dep] = lowlink[dep] = nextOrder++;
+                        sccStack.push_back(dep);
+                        onStack[dep] = true;
+                        callStack.push_back({dep, edgeStart[dep]});
+                    }
+                    else if (onStack[dep])
+                    {
+                        lowlink[node] = std::min(lowlink[node], order[dep]);
+                    }
+                    continue;
+                }
+
+                const std::uint32_t finished = node;
+                callStack.pop_back();
+                if (!callStack.empty())
+                {
+                    std::uint32_t parent = callStack.back().first;
+                    lowlink[parent] = std::min(lowlink[parent], lowlink[finished]);
+                }
+                if (lowlink[finished] != order[finished])
+                {
+                    continue;
+                }
+
+                // 強連結成分が確定
+                const size_t componentStart = std::find(sccStack.rbegin(), sccStack.rend(), finished).base() - sccStack.begin() - 1;
+                const bool cyclic = sccStack.size() - componentStart > 1 || selfLoop[finished];
+                for (size_t k = componentStart; k < sccStack.size(); ++k)
+                {
+                    onStack[sccStack[k]] = false;
+                    if (cyclic)
+                    {
+                        recursive.push_back(candidates[sccStack[k]]);
+                    }
+                }
+                sccStack.resize(componentStart);
+            }
+        }
+
+        std::sort(recursive.begin(), recursive.end());
+        return recursive;
+    }
+
+    InlinePlan::InlinePlan(const ResolvedDefinitions &definitions, const std::vector<std::vector<common::Token>> &blocks,
+                           const InlineOptions &options, common::ThreadPool *pool)
+        : inlineOptions(options)
+    {
+        using namespace common;
+
+        // ブロックごとに使用回数を数えてから合算する
+        std::vector<std::unordered_map<SymbolId, size_t>> blockUses(blocks.size());
+        ThreadPool::parallelFor(pool, blocks.size(), [&](size_t b)
+                                {
+                                    const std::vector<Token> &tokens = blocks[b];
+                                    for (size_t i = 0; i < tokens.size(); ++i)
+                                    {
+                                        if (isInlineSite(tokens, i) && definitions.find(tokens[i].symbol) != nullptr)
+                                        {
+                                            ++blockUses[b][tokens[i].symbol];
+                                        }
+                                    } });
+
+        std::unordered_map<SymbolId, size_t> uses;
+        for (const auto &counts : blockUses)
+        {
+            for (const auto &[name, count] : counts)
+            {
+                uses[name] += count;
+            }
+        }
+
+        // 各定義を評価
+        decisionList.reserve(definitions.size());
+        for (const auto &[name, definition] : definitions)
+        {
+            InlineDecision decision;
+            decision.name = name;
+            decision.tokens = definition.tokens.size();
+            auto it = uses.find(name);
+            decision.uses = (it != uses.end()) ? it->second : 0;
+            decision.growth = (decision.tokens > 0 ? decision.tokens - 1 : 0) * decision.uses;
+            decision.verdict = evaluateInlineCandidate(definition, decision.uses, options);
+            decisionList.push_back(decision);
+        }
+
+        // 展開を繰り返しても終わらない定義は展開しない
+        std::vector<SymbolId> candidates;
+        for (const auto &decision : decisionList)
+        {
+            if (decision.verdict == InlineVerdict::INLINE && definitions.find(decision.name)->circular)
+            {
+                candidates.push_back(decision.name);
+            }
+        }
+        const std::vector<SymbolId> recursive = findRecursiveInlines(definitions, candidates);
+        for (auto &decision : decisionList)
+        {
+            if (std::binary_search(recursive.begin(), recursive.end(), decision.name))
+            {
+                decision.verdict = InlineVerdict::CIRCULAR;
+            }
+        }
+
+        // 全体の予算: 増加量の少ない候補から順に採用する（同じなら名前順で決定的にする）
+        const SymbolTable &symbols = globalSymbols();
+        if (options.totalBudget != InlineOptions::UNLIMITED)
+        {
+            std::vector<InlineDecision *> candidates;
+            for (auto &decision : decisionList)
+            {
+                if (decision.verdict == InlineVerdict::INLINE)
+                {
+                    candidates.push_back(&decision);
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(), [&symbols](const InlineDecision *a, const InlineDecision *b)
+                      { return a->growth != b->growth ? a->growth < b->growth : symbols.name(a->name) < symbols.name(b->name); });
+
+            size_t spent = 0;
+            for (InlineDecision *decision : candidates)
+            {
+                if (decision->growth > options.totalBudget - spent)
+                {
+                    decision->verdict = InlineVerdict::OVER_BUDGET;
+                    continue;
+                }
+                spent += decision->growth;
+            }
+        }
+
+        std::sort(decisionList.begin(), decisionList.end(), [&symbols](const InlineDecision &a, const InlineDecision &b)
+                  { return symbols.name(a.name) < symbols.name(b.name); });
+
+        inlineByName.reserve(decisionList.size());
+        for (const auto &decision : decisionList)
+        {
+            inlineByName.emplace(decision.name, decision.verdict == InlineVerdict::INLINE);
+        }
+    }
+
+    bool InlinePlan::shouldInline(common::SymbolId name, const ResolvedDefinition &definition) const
+    {
+        if (inlineByName.empty())
+        {
+            return definition.inlinable;
+        }
+        auto it = inlineByName.find(name);
+        return it != inlineByName.end() && it->second;
+    }
+
+    // ブロックの予算を確認し、展開する箇所を記録する（予算は展開する順に使う）
+    static bool reserveInline(common::SymbolId name, const ResolvedDefinition &definition, size_t &budget, InlineStats *stats)
+    {
+        const size_t growth = definition.tokens.empty() ? 0 : definition.tokens.size() - 1;
+        if (growth > budget)
+        {
+            if (stats != nullptr && stats->perDefinition)
+            {
+                ++stats->skipped[name];
+            }
+            return false;
+        }
+        if (budget != InlineOptions::UNLIMITED)
+        {
+            budget -= growth;
+        }
+        if (stats != nullptr)
+        {
+            if (stats->perDefinition)
+            {
+                ++stats->inlined[name];
+            }
+            ++stats->inlinedCount;
+            stats->growth += growth;
+        }
+        return true;
+    }
+
+    // 展開する定義を書き出す
+    // 解決せずに残した循環する定義は、本体に残る展開する識別子をその場でさらに展開する
+    // （展開を繰り返しても終わらない定義は展開計画で除いてあるため、入れ子は必ず終わる）
+    static void appendInlined(std::vector<common::Token> &result, const ResolvedDefinition &definition,
+                              const ResolvedDefinitions &definitions, const InlinePlan &plan, size_t &budget,
+                              InlineStats *stats, bool &expandedLambda)
+    {
+        using namespace common;
+
+        expandedLambda = expandedLambda || definition.containsLambda;
+        if (!definition.circular)
+        {
+            result.insert(result.end(), definition.tokens.begin(), definition.tokens.end());
+            return;
+        }
+
+        // 書き出し中の定義と次に書き出す位置
+        std::vector<std::pair<const ResolvedDefinition *, size_t>> stack{{&definition, 0}};
+        while (!stack.empty())
+        {
+            const std::vector<Token> &tokens = stack.back().first->tokens;
+            const size_t i = stack.back().second++;
+            if (i == tokens.size())
+            {
+                stack.pop_back();
+                continue;
+            }
+            if (isInlineSite(tokens, i))
+            {
+                const SymbolId name = tokens[i].symbol;
+                const ResolvedDefinition *nested = definitions.find(name);
+                if (nested != nullptr && plan.shouldInline(name, *nested) && reserveInline(name, *nested, budget, stats))
+                {
+                    expandedLambda = expandedLambda || nested->containsLambda;
+                    if (nested->circular)
+                    {
+                        stack.push_back({nested, 0});
+                    }
+                    else
+                    {
+                        result.insert(result.end(), nested->tokens.begin(), nested->tokens.end());
+                    }
+                    continue;
+                }
+            }
+            result.push_back(tokens[i]);
+        }
+    }
+
+    std::vector<common::Token> applyDefinitions(const std::vector<common::Token> &tokens, const ResolvedDefinitions &definitions,
+                                                const InlinePlan &plan, InlineStats *stats)
+    {
+        using namespace common;
+
+        // 先頭から1回だけ走査し、展開する位置に来たらそこまでをまとめて写して定義を書き出す
+        // 解決済みの定義は展開する識別子を含まず、解決せずに残した循環する定義は書き出すときに展開し切るため、
+        // 書き出した定義を走査し直さなくても不動点に達する
+        // 展開する位置がなければ出力を組み立てず、入力を1回写すだけで済む
+        size_t budget = plan.options().blockBudget;
+        std::vector<Token> result;
+        bool expanded = false;
+        bool expandedLambda = false; // ラムダ式を含む定義を展開した
+        size_t copied = 0;           // 入力のうち result に追加済みの範囲の終わり
+        for (size_t i = 0; i < tokens.size(); ++i)
+        {
+            if (!isInlineSite(tokens, i))
+            {
+                continue;
+            }
+            const SymbolId name = tokens[i].symbol;
+            const ResolvedDefinition *definition = definitions.find(name);
+            if (definition == nullptr || !plan.shouldInline(name, *definition) || !reserveInline(name, *definition, budget, stats))
+            {
+                continue;
+            }
+
+            if (!expanded)
+            {
+                result.reserve(tokens.size() + definition->tokens.size());
+                expanded = true;
+            }
+            result.insert(result.end(), tokens.begin() + copied, tokens.begin() + i);
+            appendInlined(result, *definition, definitions, plan, budget, stats, expandedLambda);
+            copied = i + 1;
+        }
+
+        if (!expanded)
+        {
+            return processSpecialIdentifiers(tokens);
+        }
+        result.insert(result.end(), tokens.begin() + copied, tokens.end());
+
+        // 展開したラムダ式の引数（_0 から振られている）を、展開先で開いているラムダ式の引数の続きから振り直す
+        // （そのままでは展開先の _0 などと同じ名前になり、展開先の引数を隠してしまう）
+        // 処理済みの引数 _N はもう一度処理しても同じ位置になるため、ブロック全体を処理し直せばよい
+        if (expandedLambda)
+        {
+            result = processLambdaExpressions(TokenStream(std::move(result))).release();
+        }
+
+        // 特殊識別子の処理
+        return processSpecialIdentifiers(std::move(result));
+    }
+
+    // 予算の表示（無制限なら unlimited）
+    static std::string budgetText(size_t budget)
+    {
+        return budget == InlineOptions::UNLIMITED ? std::string("unlimited") : std::to_string(budget);
+    }
+
+    void writeInlineReport(std::ostream &out, const InlinePlan &plan, const std::vector<InlineStats> &blockStats)
+    {
+        // ブロックごとの実績を合算
+        std::unordered_map<common::SymbolId, size_t> inlined;
+        std::unordered_map<common::SymbolId, size_t> skipped;
+        size_t totalInlined = 0;
+        size_t totalSkipped = 0;
+        size_t totalGrowth = 0;
+        size_t blocksLimited = 0;
+        for (const auto &stats : blockStats)
+        {
+            for (const auto &[name, count] : stats.inlined)
+            {
+                inlined[name] += count;
+                totalInlined += count;
+            }
+            for (const auto &[name, count] : stats.skipped)
+            {
+                skipped[name] += count;
+                totalSkipped += count;
+            }
+            totalGrowth += stats.growth;
+            blocksLimited += stats.skipped.empty() ? 0 : 1;
+        }
+
+        const InlineOptions &options = plan.options();
+        out << "# インライン展開レポート\n";
+        out << "# 設定: max-tokens=" << options.maxTokens
+            << " single-use-tokens=" << options.maxSingleUseTokens
+            << " lambdas=" << (options.allowLambda ? "yes" : "no")
+            << " block-budget=" << budgetText(options.blockBudget)
+            << " budget=" << budgetText(options.totalBudget) << "\n";
+        out << "# 定義 " << plan.decisions().size() << " 件, 展開 " << totalInlined << " 箇所, 増加 "
+            << totalGrowth << " トークン, ブロックの予算で見送り " << totalSkipped << " 箇所（"
+            << blocksLimited << "/" << blockStats.size() << " ブロック）\n";
+
+        const common::SymbolTable &symbols = common::globalSymbols();
+        out << "name\ttokens\tuses\tgrowth\tdecision\tinlined\tskipped\n";
+        for (const auto &decision : plan.decisions())
+        {
+            auto inlinedIt = inlined.find(decision.name);
+            auto skippedIt = skipped.find(decision.name);
+            out << symbols.name(decision.name) << '\t' << decision.tokens << '\t' << decision.uses << '\t'
+                << decision.growth << '\t' << inlineVerdictName(decision.verdict) << '\t'
+                << (inlinedIt != inlined.end() ? inlinedIt->second : 0) << '\t'
+                << (skippedIt != skipped.end() ? skippedIt->second : 0) << '\n';
+        }
+    }
+
+} // namespace sign
@@ -0,0 +1,168 @@
+// src/preprocessor/inliner.h
+/**
+ * コストモデルに基づく定義のインライン展開
+ *
+ * 機能:
+ * - 定義の大きさ・使用回数・ラムダ式の有無による展開候補の評価
+ * - コード増加量の予算（コンパイル単位全体とブロックごと）の適用
+ * - 展開の判断と実績のレポート出力（設定の調整用）
+ *
+ * 既定の設定では、ラムダ式を含まず [ で始まる5トークン以下の定義を展開する
+ * （従来の規則と同じ結果になる）。解決せずに残した循環する定義も同じ規則で展開し、
+ * 展開した定義の中に残る識別子はその場でさらに展開する。ただし、展開する定義だけをたどって
+ * 自身に戻る定義（展開を繰り返しても終わらない定義）はどの設定でも展開しない。
+ *
+ * ver_20261016_5
+ */
+
+#ifndef SIGN_INLINER_H
+#define SIGN_INLINER_H
+
+#include "common/lexer/token.h"
+#include "common/utils/thread_pool.h"
+#include "preprocessor/lambda_processor.h"
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace sign
+{
+
+    // インライン展開の設定
+    struct InlineOptions
+    {
+        static constexpr size_t UNLIMITED = SIZE_MAX;
+
+        size_t maxTokens = 5;           // 展開する定義の最大トークン数
+        size_t maxSingleUseTokens = 5;  // 使用箇所が1つ以下の定義を展開する最大トークン数
+        bool allowLambda = false;       // ラムダ式を含む定義も展開する
+        size_t blockBudget = UNLIMITED; // ブロックごとのトークン増加数の上限
+        size_t totalBudget = UNLIMITED; // コンパイル単位全体のトークン増加数の上限（見積もり）
+
+        // 既定の設定かどうか
+        bool isDefault() const;
+    };
+
+    // 展開候補の評価結果
+    enum class InlineVerdict
+    {
+        INLINE,          // 展開する
+        CIRCULAR,        // 展開する定義だけをたどって自身に戻る（展開を繰り返しても終わらない）
+        CONTAINS_LAMBDA, // ラムダ式を含む
+        NOT_BRACKETED,   // [ で始まらない（展開すると結合が変わる）
+        TOO_LARGE,       // 大きすぎる
+        OVER_BUDGET      // 全体の予算を超える
+    };
+
+    // 評価結果の名前（レポート用）
+    const char *inlineVerdictName(InlineVerdict verdict);
+
+    /**
+     * 定義1件を展開候補として評価する（予算と、展開を繰り返しても終わらないかどうかは考慮しない）
+     *
+     * @param definition 解決済みの定義
+     * @param uses 使用箇所の数
+     * @param options インライン展開の設定
+     * @return 評価結果
+     */
+    InlineVerdict evaluateInlineCandidate(const ResolvedDefinition &definition, size_t uses, const InlineOptions &options);
+
+    /**
+     * 展開を繰り返しても終わらない定義を求める
+     * 展開する定義の本体に残る、展開する定義の識別子をたどって自身に戻る定義を返す。
+     * 解決済みの定義の本体は定義を持つ識別子を含まないため、たどるのは解決せずに残した循環する定義だけでよい
+     * （展開しない定義を経由する循環は、そこで展開が止まるので含まない）
+     *
+     * @param definitions 解決済みの定義
+     * @param candidates 展開する定義のうち、解決せずに残した循環する定義の識別子
+     * @return 展開を繰り返しても終わらない定義の識別子（昇順）
+     */
+    std::vector<common::SymbolId> findRecursiveInlines(const ResolvedDefinitions &definitions,
+                                                       const std::vector<common::SymbolId> &candidates);
+
+    // 定義1件の展開の判断
+    struct InlineDecision
+    {
+        common::SymbolId name = common::INVALID_SYMBOL; // 定義の識別子のID
+        size_t tokens = 0;                              // 展開済みの定義のトークン数
+        size_t uses = 0;                                // 使用箇所の数
+        size_t growth = 0;                              // すべて展開した場合のトークン増加数の見積もり
+        InlineVerdict verdict = InlineVerdict::INLINE;  // 評価結果
+    };
+
+    /**
+     * コンパイル単位全体の展開計画
+     * 全ブロックの使用回数から各定義を評価し、増加量の少ない候補から全体の予算に収まるものを採用する
+     * 構築後は変更しないため、複数ブロックの処理から共有して参照できる
+     */
+    class InlinePlan
+    {
+    public:
+        // 既定の設定の計画（解決時に計算した ResolvedDefinition::inlinable に従う）
+        InlinePlan() = default;
+
+        /**
+         * 全ブロックの使用回数を数えて展開計画を立てる
+         *
+         * @param definitions 解決済みの定義
+         * @param blocks ブロックごとのトークン列
+         * @param options インライン展開の設定
+         * @param pool 使用回数の集計に使うスレッドプール（nullptrなら直列）
+         */
+        InlinePlan(const ResolvedDefinitions &definitions, const std::vector<std::vector<common::Token>> &blocks,
+                   const InlineOptions &options, common::ThreadPool *pool = nullptr);
+
+        // 定義を展開するかどうか
+        bool shouldInline(common::SymbolId name, const ResolvedDefinition &definition) const;
+
+        // 設定
+        const InlineOptions &options() const { return inlineOptions; }
+
+        // すべての定義の判断（識別子の名前順、既定の計画では空）
+        const std::vector<InlineDecision> &decisions() const { return decisionList; }
+
+    private:
+        InlineOptions inlineOptions;
+        std::vector<InlineDecision> decisionList;
+        std::unordered_map<common::SymbolId, bool> inlineByName;
+    };
+
+    // ブロック1つの展開の実績
+    struct InlineStats
+    {
+        std::unordered_map<common::SymbolId, size_t> inlined; // 定義ごとの展開した箇所の数
+        std::unordered_map<common::SymbolId, size_t> skipped; // 定義ごとのブロックの予算で見送った箇所の数
+        size_t growth = 0;                                    // トークン増加数
+        size_t inlinedCount = 0;                              // 展開した箇所の数
+        bool perDefinition = true;                            // 定義ごとの内訳（inlined, skipped）を記録する
+    };
+
+    /**
+     * 展開計画に従ってブロックのトークン列に定義を展開する
+     * 先頭から1回だけ走査し、展開する位置ごとにそこまでの範囲をまとめて写して定義を書き出す。
+     * 解決せずに残した循環する定義は、書き出しながら中に残る展開する識別子をさらに展開する。
+     * 展開を繰り返しても終わらない定義は展開計画で除いてあるため、1回の走査で不動点に達する
+     * ラムダ式を含む定義を展開した場合は、展開先のラムダ式の引数と重ならないよう引数を振り直す
+     *
+     * @param tokens 処理対象のブロックのトークン列
+     * @param definitions 解決済みの定義
+     * @param plan 展開計画
+     * @param stats 展開の実績の記録先（nullptrなら記録しない）
+     * @return 処理されたトークン列
+     */
+    std::vector<common::Token> applyDefinitions(const std::vector<common::Token> &tokens, const ResolvedDefinitions &definitions,
+                                                const InlinePlan &plan, InlineStats *stats = nullptr);
+
+    /**
+     * 展開の判断と実績をレポートとして出力する
+     *
+     * @param out 出力先
+     * @param plan 展開計画
+     * @param blockStats ブロックごとの展開の実績
+     */
+    void writeInlineReport(std::ostream &out, const InlinePlan &plan, const std::vector<InlineStats> &blockStats);
+
+} // namespace sign
+
+#endif // SIGN_INLINER_H
@@ -3,696 +3,753 @@
  * Sign言語のラムダ式を処理する実装
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250522_0
+ * ver_20261016_20
  */
 
 #include "preprocessor/lambda_processor.h"
 #include "common/lexer/tokenizer.h"
+#include "preprocessor/inliner.h"
 #include <algorithm>
-#include <sstream>
-#include <functional>
+#include <array>
 
 namespace sign
 {
 
-    // 変数の追加
-    void Scope::addVariable(const std::string &name, const std::string &replacement)
+    // 事前にインターンしておく位置ベースの識別子の数
+    static constexpr size_t PRESET_PLACEHOLDERS = 64;
+
+    // 特殊処理する識別子のID（初回呼び出し時にインターンする）
+    struct SpecialSymbols
+    {
+        common::SymbolId nop;
+        common::SymbolId unit;
+    };
+
+    static const SpecialSymbols &specialSymbols()
+    {
+        static const SpecialSymbols symbols{common::globalSymbols().intern("nop"), common::globalSymbols().intern("_")};
+        return symbols;
+    }
+
+    void internWellKnownSymbols()
     {
-        varMap[name] = replacement;
+        ScopeStack::placeholder(0);
+        specialSymbols();
     }
 
-    // 変数の検索（現在のスコープと親スコープを探索）
-    std::string Scope::findVariable(const std::string &name) const
+    common::SymbolId ScopeStack::placeholder(size_t index)
     {
-        auto it = varMap.find(name);
-        if (it != varMap.end())
+        // 初回呼び出し時に _0 .. _63 をまとめてインターンする（初期化はスレッド安全）
+        static const std::array<common::SymbolId, PRESET_PLACEHOLDERS> preset = []
         {
-            return it->second;
-        }
+            std::array<common::SymbolId, PRESET_PLACEHOLDERS> table{};
+            for (size_t i = 0; i < table.size(); ++i)
+            {
+                table[i] = common::globalSymbols().intern("_" + std::to_string(i));
+            }
+            return table;
+        }();
 
-        if (parent)
+        if (index < preset.size())
         {
-            return parent->findVariable(name);
+            return preset[index];
         }
-
-        return ""; // 変数が見つからない場合は空文字列を返す
+        return common::globalSymbols().intern("_" + std::to_string(index));
     }
 
-    // 変数が現在のスコープに存在するか
-    bool Scope::hasVariable(const std::string &name) const
+    void ScopeStack::pushScope()
     {
-        return varMap.find(name) != varMap.end();
+        scopeStarts.push_back(bindings.size());
     }
 
-    // トークン列からラムダ式を検出して処理する
-    std::vector<common::Token> processLambdaExpressions(const std::vector<common::Token> &tokens)
+    void ScopeStack::popScope()
     {
-        using namespace common;
-
-        if (tokens.empty())
+        if (scopeStarts.empty())
         {
-            return tokens;
+            return;
         }
 
-        // 入力トークンのコピーを作成
-        std::vector<Token> result = tokens;
-
-        // 処理位置を管理するインデックス
-        size_t pos = 0;
-
-        while (pos < result.size())
+        // 後から積んだ束縛から順に取り除き、隠していた外側の束縛を戻す
+        const size_t start = scopeStarts.back();
+        scopeStarts.pop_back();
+        while (bindings.size() > start)
         {
-            // ラムダ式を探す
-            if (result[pos].type == TokenType::LAMBDA)
-            {
-                // ラムダ式を見つけた - 引数の位置と値を同時に保存
-                std::vector<std::pair<size_t, std::string>> args;
-
-                // ラムダの前にある引数を特定
-                int j = static_cast<int>(pos) - 1;
-                while (j >= 0 && result[j].type == TokenType::IDENTIFIER)
-                {
-                    // 演算子を除いた識別子部分を抽出
-                    std::string identifier = extractIdentifier(result[j].value);
-
-                    // 識別子が空でなければ引数として追加
-                    if (!identifier.empty())
-                    {
-                        args.push_back({j, identifier});
-                    }
-
-                    if (j == 0)
-                        break;
-                    j--;
-                }
-
-                // 引数を逆順に（右から左に）処理
-                std::reverse(args.begin(), args.end());
-
-                // 引数がない場合は次のトークンへ
-                if (args.empty())
-                {
-                    pos++;
-                    continue;
-                }
-
-                // 引数名と置換後の値のマッピングを作成
-                std::unordered_map<std::string, std::string> argMap;
-                for (size_t argIdx = 0; argIdx < args.size(); ++argIdx)
-                {
-                    const auto &[idx, argName] = args[argIdx];
-                    std::string replacement = "_" + std::to_string(argIdx);
-                    argMap[argName] = replacement;
-
-                    // 引数自体を置換 - 前置演算子と後置演算子を保持
-                    std::string tokenValue = result[idx].value;
-                    std::string prefixOp = extractPrefixOperator(tokenValue);
-                    std::string postfixOp = extractPostfixOperator(tokenValue);
-
-                    // 置換後の値を設定
-                    result[idx].value = prefixOp + replacement + postfixOp;
-                }
-
-                // ラムダ本体の開始位置
-                size_t bodyStart = pos + 1;
-                int nestedCount = 0;
-
-                // ラムダ本体内の変数参照を置換
-                pos = bodyStart; // 処理位置をラムダ本体の開始位置に移動
-
-                while (pos < result.size())
-                {
-                    // ネストレベルの追跡
-                    if (result[pos].type == TokenType::BRACKET_OPEN)
-                    {
-                        nestedCount++;
-                    }
-                    else if (result[pos].type == TokenType::BRACKET_CLOSE)
-                    {
-                        nestedCount--;
-                        if (nestedCount < 0)
-                            break; // ラムダ本体の終了
-                    }
+            const Binding &binding = bindings.back();
+            innermost[binding.name] = binding.shadowed;
+            bindings.pop_back();
+        }
+    }
 
-                    // 識別子を置換
-                    if (result[pos].type == TokenType::IDENTIFIER)
-                    {
-                        std::string tokenValue = result[pos].value;
-                        std::string prefixOp = extractPrefixOperator(tokenValue);
-                        std::string identifier = extractIdentifier(tokenValue);
-                        std::string postfixOp = extractPostfixOperator(tokenValue);
+    void ScopeStack::bind(common::SymbolId name, common::SymbolId replacement)
+    {
+        if (scopeStarts.empty())
+        {
+            pushScope();
+        }
+        if (name >= innermost.size())
+        {
+            innermost.resize(std::max<size_t>(name + 1, innermost.size() * 2), NO_BINDING);
+        }
 
-                        auto it = argMap.find(identifier);
-                        if (it != argMap.end())
-                        {
-                            // 置換後の値を設定（前置演算子 + 置換後の識別子 + 後置演算子）
-                            result[pos].value = prefixOp + it->second + postfixOp;
-                        }
-                    }
+        bindings.push_back({name, replacement, innermost[name]});
+        innermost[name] = static_cast<std::uint32_t>(bindings.size() - 1);
+    }
 
-                    pos++; // 次のトークンへ
-                }
+    common::SymbolId ScopeStack::find(common::SymbolId name) const
+    {
+        if (name >= innermost.size() || innermost[name] == NO_BINDING)
+        {
+            return common::INVALID_SYMBOL; // 変数が見つからない場合
+        }
+        return bindings[innermost[name]].replacement;
+    }
 
-                // posはラムダ本体終了後の位置にあるので、ループの増分で再度インクリメントしないよう継続
-                continue;
-            }
+    bool ScopeStack::boundInCurrentScope(common::SymbolId name) const
+    {
+        return !scopeStarts.empty() && name < innermost.size() &&
+               innermost[name] != NO_BINDING && innermost[name] >= scopeStarts.back();
+    }
 
-            pos++; // 次のトークンへ
+    void ScopeStack::clear()
+    {
+        while (!scopeStarts.empty())
+        {
+            popScope();
         }
-
-        return result;
     }
 
-    // トークン列から部分適用パターンを検出して処理する
-    std::vector<common::Token> processPartialApplications(const std::vector<common::Token> &tokens)
+    // トークン列からラムダ式を検出して処理する
+    // 先頭から1回だけ走査し、開いているラムダ式のスコープをスタックで管理する
+    // 各識別子はその時点で最も内側の束縛に従って一度だけ置換される
+    // 置換はトークン数と括弧・定義演算子の位置を変えないため、トークン列の索引はそのまま使える
+    common::TokenStream processLambdaExpressions(common::TokenStream result)
     {
         using namespace common;
 
-        if (tokens.empty())
+        if (result.empty())
         {
-            return tokens;
+            return result;
         }
 
-        // 入力トークンのコピーを作成
-        std::vector<Token> result = tokens;
+        // 開いているラムダ式
+        // 本体は ? と同じ括弧の深さの範囲で、次のいずれかで終わる
+        // - その括弧が閉じる
+        // - インデントが ? の行以下の行に移る（インデントされた辞書の次の項目など）
+        // - 同じ括弧の深さで , に続く次の定義が始まる（[a : x ? x, b : y ? y] の b）
+        // - ブロック末尾
+        struct ActiveLambda
+        {
+            int depth;              // ? の位置の括弧の深さ
+            size_t indent;          // ? の行のインデント
+            size_t nextPlaceholder; // 内側のラムダ式の引数に割り当てる次の位置
+        };
+        std::vector<ActiveLambda> active;
 
-        for (size_t i = 0; i < result.size(); ++i)
+        // 識別子IDで引く表は記号表全体の大きさになるため、ブロックごとに作り直さずスレッドごとに使い回す
+        // （clear は束縛した識別子の位置だけを戻す）
+        thread_local ScopeStack scopes;
+        scopes.clear();
+        int depth = 0;
+        size_t indent = 0; // 現在の行のインデント
+
+        // 現在の括弧の深さで始まり、インデントが limit 以上の行で始まったラムダ式の本体を終える
+        auto closeLambdas = [&](size_t limit)
         {
-            // 定義演算子 (:) を見つける
-            if (result[i].type == TokenType::DEFINE)
+            while (!active.empty() && active.back().depth == depth && active.back().indent >= limit)
             {
-                // 左側が単一の識別子か確認
-                if (i > 0 && result[i - 1].type == TokenType::IDENTIFIER)
-                {
-                    // 定義の右側を検索
-                    bool hasLambdaOperator = false;
-                    std::vector<size_t> unitPositions; // すべての単独 '_' 位置を記録
+                active.pop_back();
+                scopes.popScope();
+            }
+        };
 
-                    // 右側の範囲を特定
-                    size_t defineStart = i + 1;
-                    size_t defineEnd = result.size();
+        for (size_t pos = 0; pos < result.size(); ++pos)
+        {
+            const TokenType type = result.type(pos);
 
-                    // 定義の右辺が単一のUnitかチェック
-                    bool isSingleUnit = false;
-                    if (defineStart < result.size() && defineStart + 1 <= result.size())
+            if (type == TokenType::BRACKET_OPEN)
+            {
+                depth++;
+            }
+            else if (type == TokenType::BRACKET_CLOSE)
+            {
+                // 括弧が閉じたら、その内側で始まったラムダ式の本体は終了
+                depth--;
+                while (!active.empty() && active.back().depth > depth)
+                {
+                    active.pop_back();
+                    scopes.popScope();
+                }
+            }
+            else if (type == TokenType::NEWLINE)
+            {
+                // 改行トークンは改行と続くタブからなる
+                // 次の行のインデントが ? の行以下なら、その行は本体の続きではない
+                indent = result[pos].value().size() - 1;
+                closeLambdas(indent);
+            }
+            else if (type == TokenType::IDENTIFIER)
+            {
+                // , に続く定義の左辺は同じ深さの次の項目の始まり（左辺を置換する前に本体を終える）
+                if (pos > 0 && result.type(pos - 1) == TokenType::COMMA &&
+                    pos + 1 < result.size() && result.type(pos + 1) == TokenType::DEFINE)
+                {
+                    closeLambdas(0);
+                }
+
+                // 連続する識別子の先頭で、その直後が ? なら引数列として扱う
+                if (pos == 0 || result.type(pos - 1) != TokenType::IDENTIFIER)
+                {
+                    size_t runEnd = pos;
+                    while (runEnd < result.size() && result.type(runEnd) == TokenType::IDENTIFIER)
                     {
-                        if (result[defineStart].type == TokenType::IDENTIFIER &&
-                            result[defineStart].value == "_" &&
-                            (defineStart + 1 == result.size() ||
-                             result[defineStart + 1].type == TokenType::DEFINE ||
-                             result[defineStart + 1].type == TokenType::BRACKET_CLOSE))
-                        {
-                            isSingleUnit = true;
-                        }
+                        runEnd++;
                     }
 
-                    // 右側のスコープを特定
-                    int nestedLevel = 0;
-
-                    for (size_t j = defineStart; j < result.size(); ++j)
+                    if (runEnd < result.size() && result.type(runEnd) == TokenType::LAMBDA)
                     {
-                        // ネストレベルの追跡
-                        if (result[j].type == TokenType::BRACKET_OPEN)
+                        // 引数の位置は外側のラムダ式の引数の続きから振る
+                        // （同名の引数は後のものが優先、外側の同名の変数は隠される）
+                        const size_t base = active.empty() ? 0 : active.back().nextPlaceholder;
+                        size_t next = base;
+                        scopes.pushScope();
+                        for (size_t j = pos; j < runEnd; ++j)
                         {
-                            nestedLevel++;
-                        }
-                        else if (result[j].type == TokenType::BRACKET_CLOSE)
-                        {
-                            nestedLevel--;
-                            if (nestedLevel < 0 && defineEnd == result.size())
+                            // 識別子部分が空のものは引数にしない
+                            if (result[j].symbol == EMPTY_SYMBOL)
                             {
-                                defineEnd = j; // 定義の終了位置を記録
-                                break;
+                                continue;
                             }
-                        }
-
-                        // 別の定義の開始を検出
-                        if (result[j].type == TokenType::DEFINE && nestedLevel == 0)
-                        {
-                            defineEnd = j;
-                            break;
-                        }
-
-                        // ラムダ演算子を検出
-                        if (result[j].type == TokenType::LAMBDA)
-                        {
-                            hasLambdaOperator = true;
-                        }
 
-                        // 単独の '_' を検出
-                        if (result[j].type == TokenType::IDENTIFIER &&
-                            result[j].value == "_" &&
-                            extractIdentifier(result[j].value) == "_")
-                        {
-                            unitPositions.push_back(j);
+                            // 引数自体を置換 - 前置演算子と後置演算子を保持
+                            SymbolId replacement = ScopeStack::placeholder(next++);
+                            scopes.bind(result[j].symbol, replacement);
+                            result.replace(j, renameIdentifier(result[j], replacement));
                         }
-                    }
-
-                    // 単独の '_' が1つ以上含まれ、ラムダ演算子を含まず、単一Unitでない場合に変換
-                    if (!unitPositions.empty() && !hasLambdaOperator && !isSingleUnit)
-                    {
-                        // 新しいトークン列を構築
-                        std::vector<Token> newTokens;
 
-                        // ラムダ引数部分を生成 (_0 _1 ... _n)
-                        for (size_t k = 0; k < unitPositions.size(); ++k)
+                        if (next == base)
                         {
-                            std::string argName = "_" + std::to_string(k);
-                            newTokens.push_back(Token(argName, TokenType::IDENTIFIER));
+                            // 引数がない場合はスコープを作らない
+                            scopes.popScope();
                         }
-
-                        // ラムダ演算子 "?" を追加
-                        newTokens.push_back(Token("?", TokenType::LAMBDA));
-
-                        // 右側の式をコピーし、各 '_' を対応する '_k' に置き換える
-                        size_t unitIndex = 0; // 現在処理中のUnit位置インデックス
-
-                        for (size_t j = defineStart; j < defineEnd; ++j)
+                        else
                         {
-                            if (unitIndex < unitPositions.size() && j == unitPositions[unitIndex])
-                            {
-                                // 対応する引数名に置き換え
-                                std::string argName = "_" + std::to_string(unitIndex);
-                                newTokens.push_back(Token(argName, TokenType::IDENTIFIER));
-                                unitIndex++;
-                            }
-                            else
-                            {
-                                newTokens.push_back(result[j]);
-                            }
+                            active.push_back({depth, indent, next});
                         }
 
-                        // 定義の右側を新しいトークン列で置き換え
-                        result.erase(result.begin() + defineStart, result.begin() + defineEnd);
-                        result.insert(result.begin() + defineStart, newTokens.begin(), newTokens.end());
-
-                        // 位置インデックスを調整
-                        i = defineStart + newTokens.size() - 1;
+                        // ? の次（ラムダ本体）から走査を続ける
+                        pos = runEnd;
+                        continue;
                     }
                 }
+
+                // 変数参照を最も内側の束縛で置換
+                SymbolId replacement = scopes.find(result[pos].symbol);
+                if (replacement != INVALID_SYMBOL)
+                {
+                    // 置換後の値を設定（前置演算子 + 置換後の識別子 + 後置演算子）
+                    result.replace(pos, renameIdentifier(result[pos], replacement));
+                }
             }
         }
 
         return result;
     }
 
-    // すべてのブロックから定義を抽出する
-    std::unordered_map<std::string, std::vector<common::Token>> extractDefinitions(const std::vector<std::string> &blocks)
+    std::vector<common::Token> processLambdaExpressions(const std::vector<common::Token> &tokens)
+    {
+        return processLambdaExpressions(common::TokenStream(tokens)).release();
+    }
+
+    // トークン列から部分適用パターンを検出して処理する
+    // 定義演算子は種類の配列を検索して探し、右辺の範囲は索引から引く
+    // 変換する定義がなければ入力をそのまま返し、あれば変換後のトークン列を先頭から順に組み立てる
+    common::TokenStream processPartialApplications(common::TokenStream tokens)
     {
         using namespace common;
 
-        std::unordered_map<std::string, std::vector<Token>> definitions;
-        std::unordered_set<std::string> recursiveDefinitions; // 再帰的定義の検出用
+        const size_t count = tokens.size();
+        const std::vector<Token> &input = tokens.tokens();
 
-        // 各ブロックから定義を抽出
-        for (const auto &block : blocks)
+        // 変換後のトークン列（最初に変換する定義を見つけた時点で作る、引数と ? の分だけ増える）
+        std::vector<Token> output;
+        bool converted = false;
+        size_t copied = 0; // 入力のうち output に追加済みの範囲の終わり
+
+        std::vector<size_t> unitPositions; // 右辺の単独 '_' の位置
+
+        for (size_t i = tokens.find(TokenType::DEFINE, 0, count); i < count; i = tokens.find(TokenType::DEFINE, i + 1, count))
         {
-            std::vector<Token> tokens = tokenizeBlock(block);
+            // 左側が単一の識別子か確認
+            if (i == 0 || tokens.type(i - 1) != TokenType::IDENTIFIER)
+            {
+                continue;
+            }
+
+            // 右側の範囲（同じ深さの次の定義か、外側の括弧が閉じる位置まで）
+            const size_t defineStart = i + 1;
+            const size_t defineEnd = tokens.definitionEnd(i);
 
-            // 定義検出
-            for (size_t i = 0; i < tokens.size(); ++i)
+            // 定義の右辺が単一のUnitなら変換しない
+            if (defineStart < count && tokens.type(defineStart) == TokenType::IDENTIFIER &&
+                tokens[defineStart].value() == "_" &&
+                (defineStart + 1 == count ||
+                 tokens.type(defineStart + 1) == TokenType::DEFINE ||
+                 tokens.type(defineStart + 1) == TokenType::BRACKET_CLOSE))
             {
-                // 定義演算子 (:) を検出
-                if (tokens[i].type == TokenType::DEFINE)
+                continue;
+            }
+
+            // ラムダ演算子を含む右辺は変換しない
+            if (tokens.find(TokenType::LAMBDA, defineStart, defineEnd) != defineEnd)
+            {
+                continue;
+            }
+
+            // 単独の '_' の位置を記録
+            unitPositions.clear();
+            for (size_t j = defineStart; j < defineEnd; ++j)
+            {
+                if (tokens.type(j) == TokenType::IDENTIFIER && tokens[j].value() == "_")
                 {
-                    // 左側が単一の識別子か確認
-                    if (i > 0 && tokens[i - 1].type == TokenType::IDENTIFIER)
-                    {
-                        std::string definitionName = extractIdentifier(tokens[i - 1].value);
+                    unitPositions.push_back(j);
+                }
+            }
+            if (unitPositions.empty())
+            {
+                continue;
+            }
 
-                        // 右側の範囲を特定
-                        size_t defineStart = i + 1;
-                        size_t defineEnd = tokens.size();
-                        int nestedLevel = 0;
+            if (!converted)
+            {
+                output.reserve(count + count / 4);
+                converted = true;
+            }
 
-                        for (size_t j = defineStart; j < tokens.size(); ++j)
-                        {
-                            // ネストレベルの追跡
-                            if (tokens[j].type == TokenType::BRACKET_OPEN)
-                            {
-                                nestedLevel++;
-                            }
-                            else if (tokens[j].type == TokenType::BRACKET_CLOSE)
-                            {
-                                nestedLevel--;
-                                if (nestedLevel < 0 && defineEnd == tokens.size())
-                                {
-                                    defineEnd = j + 1; // 定義の終了位置を記録
-                                    break;
-                                }
-                            }
+            // 定義演算子までは入力のまま
+            output.insert(output.end(), input.begin() + copied, input.begin() + defineStart);
 
-                            // 別の定義の開始を検出
-                            if (tokens[j].type == TokenType::DEFINE && nestedLevel == 0)
-                            {
-                                defineEnd = j;
-                                break;
-                            }
-                        }
+            // 定義の右側を変換して出力に追加
+            // ラムダ引数部分を生成 (_0 _1 ... _n)
+            for (size_t k = 0; k < unitPositions.size(); ++k)
+            {
+                output.push_back(identifierToken(ScopeStack::placeholder(k)));
+            }
 
-                        // 右側の式を抽出
-                        if (defineEnd > defineStart)
-                        {
-                            std::vector<Token> definitionTokens(tokens.begin() + defineStart, tokens.begin() + defineEnd);
+            // ラムダ演算子 "?" を追加
+            output.push_back(Token("?", TokenType::LAMBDA));
 
-                            // 自己参照のチェックと処理（既存コードと同様）
-                            bool isSelfReferential = false;
-                            for (const auto &token : definitionTokens)
-                            {
-                                if (token.type == TokenType::IDENTIFIER &&
-                                    extractIdentifier(token.value) == definitionName)
-                                {
-                                    isSelfReferential = true;
-                                    recursiveDefinitions.insert(definitionName);
-                                    break;
-                                }
-                            }
+            // 右側の式をコピーし、各 '_' を対応する '_k' に置き換える
+            size_t unitIndex = 0; // 現在処理中のUnit位置インデックス
 
-                            // 自己参照でない定義のみ保存
-                            if (!isSelfReferential)
-                            {
-                                definitions[definitionName] = definitionTokens;
-                            }
-                        }
-                    }
+            for (size_t j = defineStart; j < defineEnd; ++j)
+            {
+                if (unitIndex < unitPositions.size() && j == unitPositions[unitIndex])
+                {
+                    // 対応する引数名に置き換え
+                    output.push_back(identifierToken(ScopeStack::placeholder(unitIndex)));
+                    unitIndex++;
+                }
+                else
+                {
+                    output.push_back(input[j]);
                 }
             }
+
+            // 変換済みの右側の次から走査を続ける
+            copied = defineEnd;
+            i = defineEnd - 1;
         }
 
-        return definitions;
+        if (!converted)
+        {
+            return tokens;
+        }
+
+        output.insert(output.end(), input.begin() + copied, input.end());
+        return TokenStream(std::move(output));
     }
 
-    // 与えられた定義テーブルを使用してブロックを処理する
-    std::string applyDefinitions(const std::string &block,
-                                 const std::unordered_map<std::string, std::vector<common::Token>> &definitions)
+    std::vector<common::Token> processPartialApplications(const std::vector<common::Token> &tokens)
     {
-        using namespace common;
+        return processPartialApplications(common::TokenStream(tokens)).release();
+    }
 
-        // ブロックをトークン化
-        std::vector<Token> tokens = tokenizeBlock(block);
+    // すべてのブロックから定義を抽出する（文字列版：各ブロックをトークン化して転送）
+    DefinitionTable extractDefinitions(const std::vector<std::string> &blocks)
+    {
+        std::vector<std::vector<common::Token>> tokenizedBlocks;
+        tokenizedBlocks.reserve(blocks.size());
+        for (const auto &block : blocks)
+        {
+            tokenizedBlocks.push_back(common::tokenizeBlock(block));
+        }
+        return extractDefinitions(tokenizedBlocks);
+    }
 
-        // ネストされた定義を解決
-        auto resolvedDefinitions = resolveNestedDefinitions(definitions);
+    // ブロック1つのトークン列から定義を出現順に抽出する
+    // 定義演算子は種類の配列を検索して探し、右辺の終わりは索引から引く
+    BlockDefinitions extractBlockDefinitions(const common::TokenStream &tokens)
+    {
+        using namespace common;
 
-        // 識別子置換を実行
-        std::vector<Token> result = tokens;
-        bool modified = true;
-        int iterationLimit = 10; // 無限ループ防止
+        BlockDefinitions definitions;
 
-        // ネストされた定義を処理するための複数パス
-        while (modified && iterationLimit > 0)
+        const size_t count = tokens.size();
+        for (size_t i = tokens.find(TokenType::DEFINE, 0, count); i < count; i = tokens.find(TokenType::DEFINE, i + 1, count))
         {
-            modified = false;
-            iterationLimit--;
+            // 左側が単一の識別子か確認
+            if (i == 0 || tokens.type(i - 1) != TokenType::IDENTIFIER)
+            {
+                continue;
+            }
+            SymbolId definitionName = tokens[i - 1].symbol;
 
-            for (size_t i = 0; i < result.size(); ++i)
+            // 右側の範囲を特定（外側の括弧が閉じて終わる場合は閉じ括弧まで含める）
+            size_t defineStart = i + 1;
+            size_t defineEnd = tokens.definitionEnd(i);
+            if (defineEnd < count && tokens.type(defineEnd) == TokenType::BRACKET_CLOSE)
             {
-                if (result[i].type == TokenType::IDENTIFIER)
-                {
-                    std::string identifierName = extractIdentifier(result[i].value);
+                ++defineEnd;
+            }
 
-                    // 定義文の左辺（:の左側）かどうかをチェック
-                    bool isDefinitionLHS = false;
-                    if (i + 1 < result.size() && result[i + 1].type == TokenType::DEFINE)
-                    {
-                        isDefinitionLHS = true;
-                    }
+            // 右側の式を抽出
+            if (defineEnd > defineStart)
+            {
+                std::vector<Token> definitionTokens(tokens.tokens().begin() + defineStart, tokens.tokens().begin() + defineEnd);
 
-                    // 定義文の左辺は置換しない
-                    if (isDefinitionLHS)
+                // 自己参照のチェックと処理（既存コードと同様）
+                bool isSelfReferential = false;
+                for (const auto &token : definitionTokens)
+                {
+                    if (token.type() == TokenType::IDENTIFIER &&
+                        token.symbol == definitionName)
                     {
-                        continue;
+                        isSelfReferential = true;
+                        break;
                     }
+                }
 
-                    // 定義テーブルに存在するか確認
-                    auto it = resolvedDefinitions.find(identifierName);
-                    if (it != resolvedDefinitions.end())
-                    {
-                        // 定義がラムダ式を含むかチェック
-                        bool containsLambda = false;
-                        for (const auto &token : it->second)
-                        {
-                            if (token.type == TokenType::LAMBDA)
-                            {
-                                containsLambda = true;
-                                break;
-                            }
-                        }
-
-                        // ラムダ式を含む定義はインライン展開しない
-                        if (containsLambda)
-                        {
-                            continue;
-                        }
+                // 自己参照でない定義のみ保存
+                if (!isSelfReferential)
+                {
+                    definitions.emplace_back(definitionName, std::move(definitionTokens));
+                }
+            }
+        }
 
-                        // 前置/後置演算子を除いた純粋な識別子部分
-                        std::string prefix = extractPrefixOperator(result[i].value);
-                        std::string postfix = extractPostfixOperator(result[i].value);
+        return definitions;
+    }
 
-                        // 演算子部分は保持（現時点では置換しない）
-                        if (!prefix.empty() || !postfix.empty())
-                        {
-                            continue; // 演算子付きは現時点ではスキップ
-                        }
+    BlockDefinitions extractBlockDefinitions(const std::vector<common::Token> &tokens)
+    {
+        return extractBlockDefinitions(common::TokenStream(tokens));
+    }
 
-                        // 単純な定義かどうかをチェック（さらに厳密に）
-                        bool isSimpleDefinition = true;
-                        const auto &tokens = it->second;
+    // すべてのブロックのトークン列から定義を抽出する
+    // 同名の定義は後のブロック（同じブロック内では後の定義）が優先される
+    // 索引は1つのトークン列を使い回してブロックごとに構築し直す
+    DefinitionTable extractDefinitions(const std::vector<std::vector<common::Token>> &blocks)
+    {
+        DefinitionTable definitions;
+        common::TokenStream stream;
+        for (const auto &tokens : blocks)
+        {
+            stream.assign(tokens);
+            for (auto &[name, definitionTokens] : extractBlockDefinitions(stream))
+            {
+                definitions[name] = std::move(definitionTokens);
+            }
+        }
+        return definitions;
+    }
 
-                        // 括弧で囲まれた単純な演算子のみを許可
-                        if (tokens.size() == 3 &&
-                            tokens[0].type == TokenType::BRACKET_OPEN &&
-                            tokens[2].type == TokenType::BRACKET_CLOSE &&
-                            (tokens[1].type == TokenType::OPERATOR ||
-                             (tokens[1].type == TokenType::IDENTIFIER && tokens[1].value.size() <= 2)))
-                        {
-                            // [+], [*], [^] などの単純な演算子定義
-                            isSimpleDefinition = true;
-                        }
-                        else if (tokens.size() <= 5 && tokens[0].type == TokenType::BRACKET_OPEN)
-                        {
-                            // [+ 1], [^ 2] などの単純な部分適用
-                            isSimpleDefinition = true;
-                        }
-                        else
-                        {
-                            isSimpleDefinition = false;
-                        }
+    // 与えられた定義テーブルを使用してブロックを処理する（文字列版）
+    std::string applyDefinitions(const std::string &block, const DefinitionTable &definitions)
+    {
+        std::vector<common::Token> result = applyDefinitions(common::tokenizeBlock(block), definitions);
 
-                        // 単純な定義でない場合はスキップ
-                        if (!isSimpleDefinition)
-                        {
-                            continue;
-                        }
+        // トークンを文字列に再構築
+        std::string output;
+        common::appendTokens(output, result);
+        return output;
+    }
 
-                        // 基本的なインライン展開: 定義をそのまま置換
-                        std::vector<Token> replacementTokens = it->second;
+    // 与えられた定義テーブルを使用してブロックのトークン列を処理する
+    std::vector<common::Token> applyDefinitions(const std::vector<common::Token> &tokens, const DefinitionTable &definitions)
+    {
+        return applyDefinitions(tokens, ResolvedDefinitions(definitions));
+    }
 
-                        // 元の識別子を削除し、定義内容を挿入
-                        result.erase(result.begin() + i);
-                        result.insert(result.begin() + i, replacementTokens.begin(), replacementTokens.end());
+    // 解決済みの定義を使用してブロックのトークン列を処理する
+    std::vector<common::Token> applyDefinitions(const std::vector<common::Token> &tokens, const ResolvedDefinitions &definitions)
+    {
+        // 既定の設定で展開する（展開するかどうかは解決時に計算済み）
+        return applyDefinitions(tokens, definitions, InlinePlan());
+    }
 
-                        // 位置インデックスを調整
-                        i += replacementTokens.size() - 1;
-                        modified = true;
-                    }
-                }
-            }
+    // 定義テーブルを解決し、各定義の性質を事前計算する
+    ResolvedDefinitions::ResolvedDefinitions(const DefinitionTable &definitions)
+    {
+        std::vector<common::SymbolId> circularNames;
+        DefinitionTable resolved = resolveNestedDefinitions(definitions, &circularNames);
+        std::sort(circularNames.begin(), circularNames.end());
+        entries.reserve(resolved.size());
+        for (auto &[name, tokens] : resolved)
+        {
+            ResolvedDefinition entry;
+            entry.containsLambda = std::any_of(tokens.begin(), tokens.end(), [](const common::Token &token)
+                                               { return token.type() == common::TokenType::LAMBDA; });
+            entry.circular = std::binary_search(circularNames.begin(), circularNames.end(), name);
+            entry.tokens = std::move(tokens);
+            entry.inlinable = evaluateInlineCandidate(entry, 0, InlineOptions()) == InlineVerdict::INLINE;
+            entries.emplace(name, std::move(entry));
         }
 
-        // 特殊識別子の処理
-        result = processSpecialIdentifiers(result);
-
-        // トークンを文字列に再構築
-        std::stringstream output;
-        for (size_t i = 0; i < result.size(); ++i)
+        // 展開を繰り返しても終わらない定義は展開しない
+        std::vector<common::SymbolId> candidates;
+        for (const auto &[name, entry] : entries)
         {
-            output << result[i].value;
-            if (i < result.size() - 1)
+            if (entry.circular && entry.inlinable)
             {
-                output << " ";
+                candidates.push_back(name);
             }
         }
+        for (common::SymbolId name : findRecursiveInlines(*this, candidates))
+        {
+            entries.at(name).inlinable = false;
+        }
+    }
 
-        return output.str();
+    const ResolvedDefinition *ResolvedDefinitions::find(common::SymbolId name) const
+    {
+        auto it = entries.find(name);
+        return (it != entries.end()) ? &it->second : nullptr;
     }
 
-    // ネストされた定義を解決し、展開する関数
-    std::unordered_map<std::string, std::vector<common::Token>> resolveNestedDefinitions(
-        const std::unordered_map<std::string, std::vector<common::Token>> &definitions)
+    std::shared_ptr<const ResolvedDefinitions> resolveDefinitions(const DefinitionTable &definitions)
     {
+        return std::make_shared<const ResolvedDefinitions>(definitions);
+    }
 
+    // 依存する定義を展開済みの結果で置き換えた定義を構築する
+    // resolvedOf(id) は展開する定義の展開済みトークン列（展開しない識別子ならnullptr）
+    template <typename ResolvedOf>
+    static std::vector<common::Token> expandDefinition(const std::vector<common::Token> &tokens, ResolvedOf resolvedOf)
+    {
         using namespace common;
 
-        // 結果となる定義テーブル
-        std::unordered_map<std::string, std::vector<Token>> resolvedDefs = definitions;
-
-        // 定義の依存関係を記録
-        std::unordered_map<std::string, std::unordered_set<std::string>> dependencies;
+        std::vector<Token> newDef;
+        newDef.reserve(tokens.size());
 
-        // 定義内で使用されている他の定義を検出
-        for (const auto &[name, tokens] : definitions)
+        // 定義内の識別子を展開
+        for (const auto &token : tokens)
         {
-            for (const auto &token : tokens)
+            const std::vector<Token> *resolvedDep = (token.type() == TokenType::IDENTIFIER) ? resolvedOf(token.symbol) : nullptr;
+            if (resolvedDep == nullptr)
             {
-                if (token.type == TokenType::IDENTIFIER)
-                {
-                    std::string idName = extractIdentifier(token.value);
-                    // 定義テーブルに存在する識別子の場合、依存関係に追加
-                    if (definitions.find(idName) != definitions.end() && idName != name)
-                    {
-                        dependencies[name].insert(idName);
-                    }
-                }
+                // 通常の識別子と識別子以外のトークンはそのまま追加
+                newDef.push_back(token);
+                continue;
             }
-        }
 
-        // 循環参照チェック（循環が見つかった定義は処理しない）
-        std::unordered_set<std::string> circularRefs;
-        std::function<bool(const std::string &, std::unordered_set<std::string> &)> detectCycle;
-
-        detectCycle = [&](const std::string &defName, std::unordered_set<std::string> &visited) -> bool
-        {
-            if (visited.find(defName) != visited.end())
+            // 複数トークンかつ、最初と最後が括弧でない場合のみ括弧を追加
+            bool needsBrackets = false;
+            if (resolvedDep->size() > 1)
             {
-                return true; // 循環を検出
+                bool isAlreadyBracketed = (resolvedDep->front().type() == TokenType::BRACKET_OPEN &&
+                                           resolvedDep->back().type() == TokenType::BRACKET_CLOSE);
+                needsBrackets = !isAlreadyBracketed;
             }
 
-            if (dependencies.find(defName) == dependencies.end())
+            if (needsBrackets)
             {
-                return false; // 依存関係なし
+                // 括弧で囲む
+                newDef.push_back(Token("[", TokenType::BRACKET_OPEN));
             }
 
-            visited.insert(defName);
-            for (const auto &dep : dependencies[defName])
+            // 前置・後置演算子を保持
+            if (token.prefixLength() > 0)
             {
-                if (detectCycle(dep, visited))
-                {
-                    circularRefs.insert(defName);
-                    return true;
-                }
+                newDef.push_back(token.slice(0, token.prefixLength(), TokenType::OPERATOR));
             }
-            visited.erase(defName);
-            return false;
-        };
 
-        // すべての定義の循環参照をチェック
-        for (const auto &[name, _] : definitions)
-        {
-            std::unordered_set<std::string> visited;
-            detectCycle(name, visited);
-        }
-
-        // 定義を解決するためのヘルパー関数
-        std::function<std::vector<Token>(const std::string &, std::unordered_set<std::string> &)> resolveDefinition;
+            // 展開した定義を追加
+            newDef.insert(newDef.end(), resolvedDep->begin(), resolvedDep->end());
 
-        resolveDefinition = [&](const std::string &defName, std::unordered_set<std::string> &processed) -> std::vector<Token>
-        {
-            // 循環参照を持つ定義は解決せずにそのまま返す
-            if (circularRefs.find(defName) != circularRefs.end())
+            if (token.postfixLength() > 0)
             {
-                return resolvedDefs[defName];
+                newDef.push_back(token.slice(token.value().length() - token.postfixLength(), token.postfixLength(), TokenType::OPERATOR));
             }
 
-            // 既に処理済みの定義はキャッシュから返す
-            if (processed.find(defName) != processed.end())
+            if (needsBrackets)
             {
-                return resolvedDefs[defName];
+                newDef.push_back(Token("]", TokenType::BRACKET_CLOSE));
             }
+        }
 
-            processed.insert(defName);
+        return newDef;
+    }
+
+    // ネストされた定義を解決し、展開する関数
+    // 定義の依存グラフの強連結成分を反復版のTarjan法で求め、成分が確定した順
+    // （依存先が先になる逆トポロジカル順）にそのまま展開する。
+    // 定義数と参照数の和に比例する時間で、再帰を使わないので長い依存の連鎖でもスタックを消費しない
+    DefinitionTable resolveNestedDefinitions(const DefinitionTable &definitions, std::vector<common::SymbolId> *circularNames)
+    {
+        using namespace common;
+
+        constexpr std::uint32_t UNVISITED = UINT32_MAX;
 
-            // 依存関係がない場合はそのまま返す
-            if (dependencies.find(defName) == dependencies.end() || dependencies[defName].empty())
+        // 定義に0から番号を振る
+        const size_t count = definitions.size();
+        std::vector<SymbolId> names;
+        std::vector<const std::vector<Token> *> bodies;
+        std::unordered_map<SymbolId, std::uint32_t> nodeOf;
+        names.reserve(count);
+        bodies.reserve(count);
+        nodeOf.reserve(count);
+        for (const auto &[name, tokens] : definitions)
+        {
+            nodeOf.emplace(name, static_cast<std::uint32_t>(names.size()));
+            names.push_back(name);
+            bodies.push_back(&tokens);
+        }
+
+        // 定義の依存関係を隣接配列で記録（定義内の出現順、重複と自己参照なし）
+        std::vector<size_t> edgeStart(count + 1, 0);
+        std::vector<std::uint32_t> edges;
+        std::vector<std::uint32_t> lastSource(count, UNVISITED); // 重複検出用（最後に辺を張った定義）
+        for (std::uint32_t node = 0; node < count; ++node)
+        {
+            edgeStart[node] = edges.size();
+            for (const auto &token : *bodies[node])
             {
-                return resolvedDefs[defName];
+                if (token.type() != TokenType::IDENTIFIER)
+                {
+                    continue;
+                }
+                auto it = nodeOf.find(token.symbol);
+                if (it != nodeOf.end() && it->second != node && lastSource[it->second] != node)
+                {
+                    lastSource[it->second] = node;
+                    edges.push_back(it->second);
+                }
+            }
+        }
+        edgeStart[count] = edges.size();
+
+        // 反復版Tarjan法の状態
+        std::vector<std::uint32_t> order(count, UNVISITED); // 訪問順
+        std::vector<std::uint32_t> lowlink(count, 0);
+        std::vector<bool> onStack(count, false);
+        std::vector<std::uint32_t> sccStack;
+        std::vector<std::pair<std::uint32_t, size_t>> callStack; // (定義, 次に調べる辺)
+        std::uint32_t nextOrder = 0;
+
+        // 解決結果
+        // 循環参照を持つか循環参照に到達する定義は解決せずにそのまま残す
+        std::vector<bool> circular(count, false);
+        std::vector<std::vector<Token>> resolved(count);
+        std::vector<bool> expanded(count, false);
+
+        for (std::uint32_t root = 0; root < count; ++root)
+        {
+            if (order[root] != UNVISITED)
+            {
+                continue;
             }
 
-            // 現在の定義トークンをコピー
-            std::vector<Token> currentDef = resolvedDefs[defName];
-            std::vector<Token> newDef;
+            order[root] = lowlink[root] = nextOrder++;
+            sccStack.push_back(root);
+            onStack[root] = true;
+            callStack.push_back({root, edgeStart[root]});
 
-            // 定義内の識別子を展開
-            for (const auto &token : currentDef)
+            while (!callStack.empty())
             {
-                if (token.type == TokenType::IDENTIFIER)
+                auto &[node, edge] = callStack.back();
+                if (edge < edgeStart[node + 1])
                 {
-                    std::string idName = extractIdentifier(token.value);
-
-                    // 依存する定義があり、自己参照でない場合
-                    if (definitions.find(idName) != definitions.end() &&
-                        idName != defName &&
-                        circularRefs.find(idName) == circularRefs.end())
+                    const std::uint32_t dep = edges[edge++];
+                    if (order[dep] == UNVISITED)
                     {
+                        // 依存先を先に訪問する
+                        order[dep] = lowlink[dep] = nextOrder++;
+                        sccStack.push_back(dep);
+                        onStack[dep] = true;
+                        callStack.push_back({dep, edgeStart[dep]});
+                    }
+                    else if (onStack[dep])
+                    {
+                        lowlink[node] = std::min(lowlink[node], order[dep]);
+                    }
+                    continue;
+                }
 
-                        // 依存する定義を先に解決
-                        std::vector<Token> resolvedDep = resolveDefinition(idName, processed);
-
-                        // 前置・後置演算子を保持
-                        std::string prefix = extractPrefixOperator(token.value);
-                        std::string postfix = extractPostfixOperator(token.value);
-
-                        // 展開した定義を囲む括弧が必要か判断を改善
-                        bool needsBrackets = false;
-
-                        // 複数トークンかつ、最初と最後が括弧でない場合のみ括弧を追加
-                        if (resolvedDep.size() > 1)
-                        {
-                            bool isAlreadyBracketed = (resolvedDep.front().type == TokenType::BRACKET_OPEN &&
-                                                       resolvedDep.back().type == TokenType::BRACKET_CLOSE);
-                            needsBrackets = !isAlreadyBracketed;
-                        }
-
-                        if (needsBrackets)
-                        {
-                            // 括弧で囲む
-                            newDef.push_back(Token("[", TokenType::BRACKET_OPEN));
-                        }
+                // すべての依存先を調べ終えた
+                const std::uint32_t finished = node;
+                callStack.pop_back();
+                if (!callStack.empty())
+                {
+                    std::uint32_t parent = callStack.back().first;
+                    lowlink[parent] = std::min(lowlink[parent], lowlink[finished]);
+                }
+                if (lowlink[finished] != order[finished])
+                {
+                    continue;
+                }
 
-                        if (!prefix.empty())
+                // 強連結成分が確定（依存先の成分はすべて確定済み）
+                const size_t componentStart = std::find(sccStack.rbegin(), sccStack.rend(), finished).base() - sccStack.begin() - 1;
+                bool isCircular = sccStack.size() - componentStart > 1;
+                for (size_t k = componentStart; k < sccStack.size() && !isCircular; ++k)
+                {
+                    const std::uint32_t member = sccStack[k];
+                    for (size_t e = edgeStart[member]; e < edgeStart[member + 1]; ++e)
+                    {
+                        if (circular[edges[e]])
                         {
-                            newDef.push_back(Token(prefix, TokenType::OPERATOR));
+                            isCircular = true;
+                            break;
                         }
+                    }
+                }
 
-                        // 展開した定義を追加
-                        newDef.insert(newDef.end(), resolvedDep.begin(), resolvedDep.end());
-
-                        if (!postfix.empty())
-                        {
-                            newDef.push_back(Token(postfix, TokenType::OPERATOR));
-                        }
+                for (size_t k = componentStart; k < sccStack.size(); ++k)
+                {
+                    onStack[sccStack[k]] = false;
+                    circular[sccStack[k]] = isCircular;
+                }
 
-                        if (needsBrackets)
-                        {
-                            newDef.push_back(Token("]", TokenType::BRACKET_CLOSE));
-                        }
-                    }
-                    else
+                if (!isCircular)
+                {
+                    // 循環のない成分は定義1つだけなので、展開済みの依存先で置き換える
+                    const std::uint32_t member = sccStack[componentStart];
+                    if (edgeStart[member] != edgeStart[member + 1])
                     {
-                        // 通常の識別子はそのまま追加
-                        newDef.push_back(token);
+                        resolved[member] = expandDefinition(*bodies[member], [&](SymbolId id) -> const std::vector<Token> *
+                                                            {
+                                                                auto it = nodeOf.find(id);
+                                                                if (it == nodeOf.end() || it->second == member)
+                                                                {
+                                                                    return nullptr;
+                                                                }
+                                                                return expanded[it->second] ? &resolved[it->second] : bodies[it->second]; });
+                        expanded[member] = true;
                     }
                 }
-                else
-                {
-                    // 識別子以外のトークンはそのまま追加
-                    newDef.push_back(token);
-                }
+                sccStack.resize(componentStart);
             }
+        }
 
-            // 更新された定義を保存
-            resolvedDefs[defName] = newDef;
-            return newDef;
-        };
-
-        // すべての定義を解決
-        std::unordered_set<std::string> processed;
-        for (const auto &[name, _] : resolvedDefs)
+        // 結果となる定義テーブル
+        DefinitionTable resolvedDefs;
+        resolvedDefs.reserve(count);
+        for (std::uint32_t node = 0; node < count; ++node)
         {
-            if (processed.find(name) == processed.end() &&
-                circularRefs.find(name) == circularRefs.end())
+            resolvedDefs.emplace(names[node], expanded[node] ? std::move(resolved[node]) : *bodies[node]);
+            if (circularNames != nullptr && circular[node])
             {
-                resolveDefinition(name, processed);
+                circularNames->push_back(names[node]);
             }
         }
 
@@ -700,26 +757,25 @@ namespace sign
     }
 
     // 特殊識別子を適切に処理する
-    std::vector<common::Token> processSpecialIdentifiers(const std::vector<common::Token> &tokens)
+    std::vector<common::Token> processSpecialIdentifiers(std::vector<common::Token> tokens)
     {
         using namespace common;
 
-        std::vector<Token> result = tokens;
+        const SymbolId nopSymbol = specialSymbols().nop;
+        const SymbolId unitSymbol = specialSymbols().unit;
 
-        for (size_t i = 0; i < result.size(); i++)
+        for (size_t i = 0; i < tokens.size(); i++)
         {
             // 特殊識別子の処理
-            if (result[i].type == TokenType::IDENTIFIER)
+            if (tokens[i].type() == TokenType::IDENTIFIER)
             {
-                std::string idName = extractIdentifier(result[i].value);
-
                 // nop の特殊処理: nop → _
-                if (idName == "nop")
+                if (tokens[i].symbol == nopSymbol)
                 {
                     // 定義コンテキストでnopが使われている場合
-                    if (i > 0 && result[i - 1].type == TokenType::DEFINE)
+                    if (i > 0 && tokens[i - 1].type() == TokenType::DEFINE)
                     {
-                        result[i] = Token("_", TokenType::IDENTIFIER);
+                        tokens[i] = identifierToken(unitSymbol);
                     }
                     // 関数呼び出しコンテキストでnopが使われている場合は置換しない
                 }
@@ -728,7 +784,7 @@ namespace sign
             }
         }
 
-        return result;
+        return tokens;
     }
 
 } // namespace sign
\ No newline at end of file
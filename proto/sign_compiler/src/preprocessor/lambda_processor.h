@@ -5,43 +5,130 @@
  * 機能:
  * - ラムダ式の検出と変数置換
  * - 引数名を位置ベースの識別子に変換
- * - スコープ管理と変換済みラムダ式の再構築
+ * - 平坦なスコープスタックによる引数の束縛管理
+ * - 変換済みラムダ式の再構築
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250522_0
+ * ver_20261016_11
  */
 
 #ifndef SIGN_LAMBDA_PROCESSOR_H
 #define SIGN_LAMBDA_PROCESSOR_H
 
 // 直接共通モジュールを参照するように変更
+#include "common/lexer/symbol_table.h"
 #include "common/lexer/token.h"
+#include "common/lexer/token_stream.h"
 #include "common/lexer/tokenizer.h"
 #include <string>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <utility>
 
 namespace sign
 {
 
-    // スコープを表す構造体
-    struct Scope
+    // 定義テーブル (識別子のID -> 定義トークン)
+    using DefinitionTable = std::unordered_map<common::SymbolId, std::vector<common::Token>>;
+
+    // ブロック1つから抽出した定義（識別子のID, 定義トークン）の出現順の列
+    using BlockDefinitions = std::vector<std::pair<common::SymbolId, std::vector<common::Token>>>;
+
+    // 展開済みの定義1件と、展開時に毎回調べていた性質の事前計算結果
+    struct ResolvedDefinition
+    {
+        std::vector<common::Token> tokens; // ネストした定義を展開済みのトークン列
+        bool containsLambda = false;       // ラムダ式を含む（インライン展開しない）
+        bool circular = false;             // 循環参照を持つか循環参照に到達する（展開せずに元のまま残す）
+        bool inlinable = false;            // 既定の設定でインライン展開する定義（inliner.h）
+    };
+
+    /**
+     * コンパイル単位ごとに一度だけ解決した定義の集合
+     * 構築後は変更しないため、複数ブロックの処理から共有して参照できる
+     */
+    class ResolvedDefinitions
+    {
+    public:
+        /**
+         * 定義テーブルのネストした定義を解決して構築する
+         * 各定義の展開は構築時に一度だけ計算する
+         *
+         * @param definitions 元の定義テーブル
+         */
+        explicit ResolvedDefinitions(const DefinitionTable &definitions);
+
+        // 定義の検索（見つからなければnullptr）
+        const ResolvedDefinition *find(common::SymbolId name) const;
+
+        // 定義の数
+        size_t size() const { return entries.size(); }
+
+        // すべての定義の走査（順序は不定）
+        auto begin() const { return entries.begin(); }
+        auto end() const { return entries.end(); }
+
+    private:
+        std::unordered_map<common::SymbolId, ResolvedDefinition> entries;
+    };
+
+    /**
+     * ラムダ式の引数の束縛を管理する平坦なスコープスタック
+     *
+     * 束縛はすべて1本の配列に積み、スコープは配列上の範囲として push/pop する。
+     * 識別子IDごとに最も内側の束縛の位置を保持し、各束縛は同じ識別子の
+     * 1つ外側の束縛の位置を持つ（識別子ごとのシャドウスタック）ので、
+     * 検索は親スコープをたどらずに O(1) で行える。
+     */
+    class ScopeStack
     {
-        std::unordered_map<std::string, std::string> varMap; // 変数名と変換後の名前のマッピング
-        std::shared_ptr<Scope> parent;                       // 親スコープ
+    public:
+        // 新しいスコープを開始する
+        void pushScope();
+
+        // 最も内側のスコープを終了し、その束縛をすべて取り除く
+        void popScope();
+
+        // 最も内側のスコープに変数を束縛する（外側の同名の束縛は隠される）
+        void bind(common::SymbolId name, common::SymbolId replacement);
+
+        // 変数の検索（最も内側の束縛の置換後の名前ID、見つからなければINVALID_SYMBOL）
+        common::SymbolId find(common::SymbolId name) const;
 
-        // コンストラクタ
-        Scope(std::shared_ptr<Scope> p = nullptr) : parent(p) {}
+        // 変数が最も内側のスコープで束縛されているか
+        bool boundInCurrentScope(common::SymbolId name) const;
 
-        // 変数の追加
-        void addVariable(const std::string &name, const std::string &replacement);
+        // 開いているスコープの数
+        size_t depth() const { return scopeStarts.size(); }
 
-        // 変数の検索（現在のスコープと親スコープを探索）
-        std::string findVariable(const std::string &name) const;
+        // すべてのスコープを終了する
+        void clear();
 
-        // 変数が現在のスコープに存在するか
-        bool hasVariable(const std::string &name) const;
+        /**
+         * 位置ベースの識別子 (_0, _1 ...) のIDを返す
+         * よく使う範囲は事前にインターンした表から引く
+         *
+         * @param index 引数の位置
+         * @return 識別子 _index のID
+         */
+        static common::SymbolId placeholder(size_t index);
+
+    private:
+        static constexpr std::uint32_t NO_BINDING = UINT32_MAX;
+
+        // 束縛1件
+        struct Binding
+        {
+            common::SymbolId name;        // 変数のID
+            common::SymbolId replacement; // 置換後の名前のID
+            std::uint32_t shadowed;       // 同じ変数の1つ外側の束縛の位置（なければNO_BINDING）
+        };
+
+        std::vector<Binding> bindings;       // すべてのスコープの束縛（内側ほど後ろ）
+        std::vector<size_t> scopeStarts;     // 各スコープの最初の束縛の位置
+        std::vector<std::uint32_t> innermost; // 識別子IDごとの最も内側の束縛の位置
     };
 
     /**
@@ -52,6 +139,15 @@ namespace sign
      */
     std::vector<common::Token> processLambdaExpressions(const std::vector<common::Token> &tokens);
 
+    /**
+     * 索引付きのトークン列からラムダ式を検出して処理する
+     * 置換はトークン数と括弧・定義演算子の位置を変えないため、索引はそのまま引き継がれる
+     *
+     * @param tokens 処理対象のトークン列
+     * @return 変数が位置ベースの識別子に置換されたトークン列
+     */
+    common::TokenStream processLambdaExpressions(common::TokenStream tokens);
+
     /**
      * トークン列から部分適用パターンを検出して処理する
      * 例: `f : g _ 2 _` → `f : _0 _1 ? g _0 2 _1`
@@ -61,13 +157,51 @@ namespace sign
      */
     std::vector<common::Token> processPartialApplications(const std::vector<common::Token> &tokens);
 
+    /**
+     * 索引付きのトークン列から部分適用パターンを検出して処理する
+     * 定義の右辺の範囲は入力の索引から引く（変換する定義がなければ入力をそのまま返す）
+     *
+     * @param tokens 処理対象のトークン列
+     * @return 部分適用がラムダ式に変換されたトークン列
+     */
+    common::TokenStream processPartialApplications(common::TokenStream tokens);
+
     /**
      * すべてのブロックから定義を抽出する
+     * 定義トークンはblocksへのビューなので、blocksは定義テーブルより長く生存する必要がある
      *
      * @param blocks 処理対象のコードブロック配列
-     * @return 定義テーブル (識別子 -> 定義トークン)
+     * @return 定義テーブル (識別子のID -> 定義トークン)
+     */
+    DefinitionTable extractDefinitions(const std::vector<std::string> &blocks);
+
+    /**
+     * ブロック1つのトークン列から定義を抽出する
+     * 自己参照する定義は含まない
+     *
+     * @param tokens ブロックのトークン列
+     * @return 抽出した定義（出現順）
+     */
+    BlockDefinitions extractBlockDefinitions(const std::vector<common::Token> &tokens);
+
+    /**
+     * 索引付きのトークン列から定義を抽出する
+     * 定義の右辺の終わりは索引から引く（右辺を走査して括弧の深さを数え直さない）
+     *
+     * @param tokens ブロックのトークン列
+     * @return 抽出した定義（出現順）
+     */
+    BlockDefinitions extractBlockDefinitions(const common::TokenStream &tokens);
+
+    /**
+     * すべてのブロックのトークン列から定義を抽出する
+     * 定義トークンはblocksのトークンのコピーなので、トークンが参照する元のバッファは
+     * 定義テーブルより長く生存する必要がある
+     *
+     * @param blocks 処理対象のブロックごとのトークン列
+     * @return 定義テーブル (識別子のID -> 定義トークン)
      */
-    std::unordered_map<std::string, std::vector<common::Token>> extractDefinitions(const std::vector<std::string> &blocks);
+    DefinitionTable extractDefinitions(const std::vector<std::vector<common::Token>> &blocks);
 
     /**
      * 与えられた定義テーブルを使用してブロックを処理する
@@ -76,25 +210,61 @@ namespace sign
      * @param definitions 定義テーブル
      * @return 処理されたコードブロック
      */
-    std::string applyDefinitions(const std::string &block,
-                                 const std::unordered_map<std::string, std::vector<common::Token>> &definitions);
+    std::string applyDefinitions(const std::string &block, const DefinitionTable &definitions);
+
+    /**
+     * 与えられた定義テーブルを使用してブロックのトークン列を処理する
+     *
+     * @param tokens 処理対象のブロックのトークン列
+     * @param definitions 定義テーブル
+     * @return 処理されたトークン列
+     */
+    std::vector<common::Token> applyDefinitions(const std::vector<common::Token> &tokens, const DefinitionTable &definitions);
+
+    /**
+     * 解決済みの定義を使用してブロックのトークン列を処理する
+     * 定義の解決はコンパイル単位ごとに一度だけ行い、全ブロックで共有する
+     *
+     * @param tokens 処理対象のブロックのトークン列
+     * @param definitions 解決済みの定義
+     * @return 処理されたトークン列
+     */
+    std::vector<common::Token> applyDefinitions(const std::vector<common::Token> &tokens, const ResolvedDefinitions &definitions);
+
+    /**
+     * 定義テーブルを一度だけ解決し、共有可能な不変の構造として返す
+     *
+     * @param definitions 元の定義テーブル
+     * @return 解決済みの定義
+     */
+    std::shared_ptr<const ResolvedDefinitions> resolveDefinitions(const DefinitionTable &definitions);
 
     /**
      * ネストされた定義を解決し、展開する
+     * 循環参照を持つか循環参照に到達する定義は展開せずに元のまま残す
+     * （それ以外の定義の展開結果は、定義を持つ識別子を含まない）
      *
      * @param definitions 元の定義テーブル
+     * @param circularNames 展開しなかった循環する定義の識別子の記録先（nullptrなら記録しない）
      * @return 依存関係を解決した定義テーブル
      */
-    std::unordered_map<std::string, std::vector<common::Token>> resolveNestedDefinitions(
-        const std::unordered_map<std::string, std::vector<common::Token>> &definitions);
+    DefinitionTable resolveNestedDefinitions(const DefinitionTable &definitions,
+                                             std::vector<common::SymbolId> *circularNames = nullptr);
+
+    /**
+     * プリプロセッサがIDを保持し続ける識別子（_0 .. _63、nop、_）をインターンする
+     * シンボルテーブルの truncate で戻す位置を記録する前に呼び、これらのIDが破棄されないようにする
+     */
+    void internWellKnownSymbols();
 
     /**
      * 特殊識別子を適切に処理する
+     * 受け取ったトークン列をその場で書き換えて返す（不要になるトークン列は std::move で渡せば写さない）
      *
      * @param tokens 処理対象のトークン列
      * @return 特殊処理されたトークン列
      */
-    std::vector<common::Token> processSpecialIdentifiers(const std::vector<common::Token> &tokens);
+    std::vector<common::Token> processSpecialIdentifiers(std::vector<common::Token> tokens);
 
 } // namespace sign
 
@@ -0,0 +1,52 @@
+// src/preprocessor/occurrence_index.cpp
+/**
+ * 識別子の参照位置の索引の実装
+ *
+ * ver_20261016_1
+ */
+
+#include "preprocessor/occurrence_index.h"
+#include <algorithm>
+
+namespace sign
+{
+
+    // 識別子のID順、同じ識別子の中では出現順
+    static bool occurrenceLess(const Occurrence &a, const Occurrence &b)
+    {
+        return a.symbol != b.symbol ? a.symbol < b.symbol : a.position < b.position;
+    }
+
+    OccurrenceIndex::OccurrenceIndex(const std::vector<common::Token> &tokens)
+    {
+        using common::TokenType;
+
+        for (size_t i = 0; i < tokens.size(); ++i)
+        {
+            if (tokens[i].type() == TokenType::IDENTIFIER &&
+                !(i + 1 < tokens.size() && tokens[i + 1].type() == TokenType::DEFINE))
+            {
+                entries.push_back(Occurrence{tokens[i].symbol, static_cast<std::uint32_t>(i)});
+            }
+        }
+        std::sort(entries.begin(), entries.end(), occurrenceLess);
+    }
+
+    std::vector<size_t> OccurrenceIndex::references(common::SymbolId name) const
+    {
+        auto first = std::lower_bound(entries.begin(), entries.end(), Occurrence{name, 0}, occurrenceLess);
+        std::vector<size_t> positions;
+        for (auto it = first; it != entries.end() && it->symbol == name; ++it)
+        {
+            positions.push_back(it->position);
+        }
+        return positions;
+    }
+
+    bool OccurrenceIndex::contains(common::SymbolId name) const
+    {
+        auto it = std::lower_bound(entries.begin(), entries.end(), Occurrence{name, 0}, occurrenceLess);
+        return it != entries.end() && it->symbol == name;
+    }
+
+} // namespace sign
@@ -0,0 +1,78 @@
+// src/preprocessor/occurrence_index.h
+/**
+ * 識別子の参照位置の索引
+ *
+ * 機能:
+ * - ブロックのトークン列で、識別子ごとにそれを参照している位置を引ける転置索引
+ * - 差分プリプロセスで、変わった定義を参照するブロックの判定
+ * - エディタ連携での参照の検索
+ *
+ * 索引はブロックごとに1回構築して保持する（識別子ごとにまとめるため整列する）。
+ * 1回だけ先頭から処理する用途（定義の適用など）はトークン列を直接走査する。
+ *
+ * 定義文の左辺（直後が定義演算子 : の識別子）は参照に含めない。
+ * 前置・後置演算子付きの識別子は参照に含める（インライン展開の対象かどうかは利用側で判断する）。
+ *
+ * ver_20261016_1
+ */
+
+#ifndef SIGN_OCCURRENCE_INDEX_H
+#define SIGN_OCCURRENCE_INDEX_H
+
+#include "common/lexer/symbol_table.h"
+#include "common/lexer/token.h"
+#include <cstdint>
+#include <vector>
+
+namespace sign
+{
+
+    // 識別子の参照1件
+    struct Occurrence
+    {
+        common::SymbolId symbol; // 参照している識別子のID
+        std::uint32_t position;  // トークン列での位置
+    };
+
+    /**
+     * ブロック1つの参照位置の索引
+     * 参照は識別子のIDごとにまとめ、同じ識別子の中では出現順に並べる
+     */
+    class OccurrenceIndex
+    {
+    public:
+        OccurrenceIndex() = default;
+
+        /**
+         * トークン列を1回走査して索引を構築する
+         *
+         * @param tokens ブロックのトークン列
+         */
+        explicit OccurrenceIndex(const std::vector<common::Token> &tokens);
+
+        // 参照の数
+        size_t size() const { return entries.size(); }
+        bool empty() const { return entries.empty(); }
+
+        // すべての参照（識別子のIDごと、同じ識別子の中では出現順）
+        auto begin() const { return entries.begin(); }
+        auto end() const { return entries.end(); }
+
+        /**
+         * 識別子を参照している位置を返す
+         *
+         * @param name 識別子のID
+         * @return 参照の位置（出現順、参照がなければ空）
+         */
+        std::vector<size_t> references(common::SymbolId name) const;
+
+        // 識別子を参照しているか
+        bool contains(common::SymbolId name) const;
+
+    private:
+        std::vector<Occurrence> entries;
+    };
+
+} // namespace sign
+
+#endif // SIGN_OCCURRENCE_INDEX_H
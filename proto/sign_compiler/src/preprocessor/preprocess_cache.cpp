@@ -0,0 +1,247 @@
+// src/preprocessor/preprocess_cache.cpp
+/**
+ * 前処理結果のディスクキャッシュの実装
+ *
+ * エントリファイルの形式（<キー16進>.snpc、整数は実行環境のバイト順）:
+ * - ヘッダ: マジック(8) バイト順確認(4) 形式版(4) 入力長(8) 入力の検証ハッシュ(8)
+ *           出力長(8) 本体ハッシュ(8)
+ * - 出力: 最終出力のバイト列
+ *
+ * ver_20261016_2
+ */
+
+#include "preprocessor/preprocess_cache.h"
+#include "common/utils/hash.h"
+#include "common/version.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace sign
+{
+
+    namespace fs = std::filesystem;
+
+    namespace
+    {
+        constexpr char MAGIC[8] = {'S', 'I', 'G', 'N', 'P', 'P', 'C', '2'};
+        constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+        constexpr const char *ENTRY_EXTENSION = ".snpc";
+        constexpr const char *TEMP_EXTENSION = ".tmp";
+
+        // キーと検証用ハッシュで異なる初期値を使う
+        constexpr std::uint64_t KEY_SEED = 0x5349474e4b455931ULL;
+        constexpr std::uint64_t CHECK_SEED = 0x5349474e43484b31ULL;
+
+        // ヘッダ
+        struct EntryHeader
+        {
+            char magic[8];
+            std::uint32_t byteOrder;
+            std::uint32_t formatVersion;
+            std::uint64_t inputLength;
+            std::uint64_t inputCheck;
+            std::uint64_t outputLength;
+            std::uint64_t bodyHash;
+        };
+
+        // コンパイラのバージョンを含めたキャッシュのキー
+        std::uint64_t cacheKey(std::string_view sourceCode)
+        {
+            const std::uint64_t versionSeed =
+                common::hashBytes(common::COMPILER_VERSION, KEY_SEED ^ common::PREPROCESS_FORMAT_VERSION);
+            return common::hashBytes(sourceCode, versionSeed);
+        }
+
+        // 他のプロセス・スレッドと衝突しない一時ファイル名
+        std::string temporaryName()
+        {
+            static std::atomic<std::uint64_t> counter{0};
+            static const std::uint64_t processSalt = std::random_device{}();
+            const std::uint64_t unique = processSalt ^
+                                         (std::hash<std::thread::id>{}(std::this_thread::get_id()) << 16) ^
+                                         static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^
+                                         (counter.fetch_add(1) << 48);
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(unique));
+            return std::string(name) + TEMP_EXTENSION;
+        }
+    } // namespace
+
+    PreprocessCache::PreprocessCache(std::string directory, std::uint64_t maxBytes)
+        : directory(std::move(directory)), maxBytes(maxBytes)
+    {
+        std::error_code ec;
+        fs::create_directories(this->directory, ec);
+        if (ec || !fs::is_directory(this->directory))
+        {
+            throw std::runtime_error("キャッシュディレクトリを作成できませんでした: " + this->directory);
+        }
+    }
+
+    std::string PreprocessCache::entryPath(std::string_view sourceCode) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(cacheKey(sourceCode)));
+        return (fs::path(directory) / (std::string(name) + ENTRY_EXTENSION)).string();
+    }
+
+    std::optional<CacheEntry> PreprocessCache::lookup(std::string_view sourceCode) const
+    {
+        const std::string path = entryPath(sourceCode);
+
+        // エントリ全体を1回で読み込む
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            return std::nullopt;
+        }
+        const std::streamoff size = file.tellg();
+        if (size < static_cast<std::streamoff>(sizeof(EntryHeader)))
+        {
+            return std::nullopt;
+        }
+        CacheEntry entry;
+        entry.data.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        if (!file.read(entry.data.data(), size))
+        {
+            return std::nullopt;
+        }
+        file.close();
+
+        // ヘッダと内容の検証（キーの衝突・書きかけ・破損したエントリは使用しない）
+        EntryHeader header;
+        std::memcpy(&header, entry.data.data(), sizeof(header));
+        const std::string_view body = std::string_view(entry.data).substr(sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header.byteOrder != BYTE_ORDER_MARK ||
+            header.formatVersion != common::PREPROCESS_FORMAT_VERSION ||
+            header.inputLength != sourceCode.size() ||
+            header.outputLength != body.size() ||
+            header.inputCheck != common::hashBytes(sourceCode, CHECK_SEED) ||
+            header.bodyHash != common::hashBytes(body))
+        {
+            return std::nullopt;
+        }
+
+        entry.output = body;
+
+        // LRUのため最終使用時刻を更新（失敗しても結果には影響しない）
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+        return entry;
+    }
+
+    bool PreprocessCache::store(std::string_view sourceCode, std::string_view output) const
+    {
+        EntryHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.formatVersion = common::PREPROCESS_FORMAT_VERSION;
+        header.inputLength = sourceCode.size();
+        header.inputCheck = common::hashBytes(sourceCode, CHECK_SEED);
+        header.outputLength = output.size();
+        header.bodyHash = common::hashBytes(output);
+
+        // 一時ファイルに書き込んでから名前を変更する（読み手は完成したエントリのみを見る）
+        const fs::path temporary = fs::path(directory) / temporaryName();
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                return false;
+            }
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(output.data(), static_cast<std::streamsize>(output.size()));
+            if (!file.good())
+            {
+                file.close();
+                std::error_code ec;
+                fs::remove(temporary, ec);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(temporary, entryPath(sourceCode), ec);
+        if (ec)
+        {
+            fs::remove(temporary, ec);
+            return false;
+        }
+
+        evict();
+        return true;
+    }
+
+    void PreprocessCache::evict() const
+    {
+        struct EntryFile
+        {
+            fs::path path;
+            std::uint64_t size;
+            fs::file_time_type lastUse;
+        };
+
+        // 他のプロセスが同時に削除・追加していてもエラーにしない
+        std::vector<EntryFile> entries;
+        std::uint64_t total = 0;
+        const auto now = fs::file_time_type::clock::now();
+        std::error_code ec;
+        for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+        {
+            std::error_code entryError;
+            const fs::path &path = it->path();
+            const std::uint64_t size = it->file_size(entryError);
+            const fs::file_time_type lastUse = it->last_write_time(entryError);
+            if (entryError)
+            {
+                continue;
+            }
+
+            if (path.extension() == ENTRY_EXTENSION)
+            {
+                entries.push_back({path, size, lastUse});
+                total += size;
+            }
+            else if (path.extension() == TEMP_EXTENSION && now - lastUse > std::chrono::hours(1))
+            {
+                // 書き込み中に異常終了したプロセスの一時ファイル
+                fs::remove(path, entryError);
+            }
+        }
+
+        if (total <= maxBytes)
+        {
+            return;
+        }
+
+        // 最終使用時刻の古い順に、上限の3/4まで削除する（削除のたびに走査しないよう余裕を持たせる）
+        std::sort(entries.begin(), entries.end(), [](const EntryFile &a, const EntryFile &b)
+                  { return a.lastUse < b.lastUse; });
+        const std::uint64_t target = maxBytes / 4 * 3;
+        for (const auto &entry : entries)
+        {
+            if (total <= target)
+            {
+                break;
+            }
+            std::error_code removeError;
+            if (fs::remove(entry.path, removeError) || !removeError)
+            {
+                total -= entry.size;
+            }
+        }
+    }
+
+} // namespace sign
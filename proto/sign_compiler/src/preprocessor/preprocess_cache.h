@@ -0,0 +1,85 @@
+// src/preprocessor/preprocess_cache.h
+/**
+ * 前処理結果をディスクに保存する内容アドレス方式のキャッシュ
+ *
+ * 機能:
+ * - 入力のハッシュとコンパイラのバージョンをキーとするエントリの保存と検索
+ * - 最終出力を1ファイルに格納
+ * - 一時ファイルへの書き込みと名前変更による原子的な保存（複数プロセスから同時に使用可能）
+ * - 最終使用時刻（更新日時）による容量上限付きのLRU削除
+ *
+ * ver_20261016_1
+ */
+
+#ifndef SIGN_PREPROCESS_CACHE_H
+#define SIGN_PREPROCESS_CACHE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace sign
+{
+
+    // キャッシュから読み込んだエントリ
+    struct CacheEntry
+    {
+        std::string data;        // エントリファイルの内容（1回の読み込み）
+        std::string_view output; // 最終出力（dataへのビュー）
+    };
+
+    class PreprocessCache
+    {
+    public:
+        // 既定の容量上限（256MB）
+        static constexpr std::uint64_t DEFAULT_MAX_BYTES = std::uint64_t(256) << 20;
+
+        /**
+         * キャッシュを開く（ディレクトリがなければ作成する）
+         *
+         * @param directory キャッシュディレクトリ
+         * @param maxBytes 容量上限（超えた場合は古いエントリから削除）
+         * @throws std::runtime_error ディレクトリを作成できない場合
+         */
+        explicit PreprocessCache(std::string directory, std::uint64_t maxBytes = DEFAULT_MAX_BYTES);
+
+        /**
+         * 入力に対応するエントリを検索する
+         * ヒットした場合はエントリの最終使用時刻を更新する
+         *
+         * @param sourceCode 入力ソースコード
+         * @return エントリ（ない場合や壊れている場合は std::nullopt）
+         */
+        std::optional<CacheEntry> lookup(std::string_view sourceCode) const;
+
+        /**
+         * エントリを保存し、容量上限を超えていれば古いエントリを削除する
+         *
+         * @param sourceCode 入力ソースコード
+         * @param output 最終出力
+         * @return 保存できた場合はtrue
+         */
+        bool store(std::string_view sourceCode, std::string_view output) const;
+
+        /**
+         * 容量上限を超えている場合、最終使用時刻の古いエントリから削除する
+         */
+        void evict() const;
+
+        /**
+         * 入力に対応するエントリファイルのパスを返す
+         *
+         * @param sourceCode 入力ソースコード
+         * @return エントリファイルのパス
+         */
+        std::string entryPath(std::string_view sourceCode) const;
+
+    private:
+        std::string directory;
+        std::uint64_t maxBytes;
+    };
+
+} // namespace sign
+
+#endif // SIGN_PREPROCESS_CACHE_H
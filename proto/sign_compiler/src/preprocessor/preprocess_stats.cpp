@@ -0,0 +1,148 @@
+// src/preprocessor/preprocess_stats.cpp
+/**
+ * プリプロセスの段階ごとの統計の出力
+ *
+ * ver_20261016_2
+ */
+
+#include "preprocessor/preprocess_stats.h"
+#include <iomanip>
+
+namespace sign
+{
+
+    const char *preprocessStageName(PreprocessStage stage)
+    {
+        switch (stage)
+        {
+        case PreprocessStage::NORMALIZE:
+            return "normalize";
+        case PreprocessStage::TOKENIZE:
+            return "tokenize";
+        case PreprocessStage::LAMBDA:
+            return "lambda";
+        case PreprocessStage::PARTIAL:
+            return "partial";
+        case PreprocessStage::EXTRACT_DEFINITIONS:
+            return "extract-definitions";
+        case PreprocessStage::RESOLVE:
+            return "resolve";
+        case PreprocessStage::APPLY:
+            return "apply";
+        case PreprocessStage::GENERATE:
+            return "generate";
+        case PreprocessStage::COUNT:
+            break;
+        }
+        return "unknown";
+    }
+
+    static double milliseconds(std::uint64_t nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / 1e6;
+    }
+
+    void writeStatsText(std::ostream &out, const PreprocessStats &stats)
+    {
+        const std::ios::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+
+        out << "===== 統計 =====" << std::endl;
+        if (stats.cacheHit)
+        {
+            out << "入力: " << stats.inputBytes << " bytes" << std::endl;
+            out << "キャッシュの結果を使用（段階ごとの処理なし）" << std::endl;
+        }
+        else
+        {
+            out << "入力: " << stats.inputBytes << " bytes, " << stats.blocks << " ブロック" << std::endl;
+
+            std::uint64_t stageTotal = 0;
+            std::uint64_t allocatedBytes = 0;
+            for (const auto &stage : stats.stages)
+            {
+                stageTotal += stage.nanoseconds.load();
+                allocatedBytes += stage.allocatedBytes.load();
+            }
+
+            // 列の幅はバイト数で揃うため、見出しは段階名と同じく ASCII にする
+            out << std::left << std::setw(20) << "stage" << std::right << std::setw(12) << "ms" << std::setw(8) << "%"
+                << std::setw(12) << "tokens" << std::setw(12) << "alloc KB" << std::endl;
+            out << std::fixed;
+            for (size_t i = 0; i < PREPROCESS_STAGE_COUNT; ++i)
+            {
+                const StageStats &stage = stats.stages[i];
+                const std::uint64_t nanoseconds = stage.nanoseconds.load();
+                out << std::left << std::setw(20) << preprocessStageName(static_cast<PreprocessStage>(i)) << std::right
+                    << std::setprecision(3) << std::setw(12) << milliseconds(nanoseconds)
+                    << std::setprecision(1) << std::setw(7)
+                    << (stageTotal > 0 ? 100.0 * static_cast<double>(nanoseconds) / static_cast<double>(stageTotal) : 0.0) << "%"
+                    << std::setw(12) << stage.tokens.load()
+                    << std::setw(12) << (stage.allocatedBytes.load() + 1023) / 1024 << std::endl;
+            }
+            out << "（ブロックごとの段階の時間は各スレッドの合計）" << std::endl;
+            out << "定義: " << stats.definitions << " 件（解決 " << stats.resolvedDefinitions << " 件, 循環 "
+                << stats.definitions - stats.resolvedDefinitions << " 件）" << std::endl;
+            out << "インライン展開: " << stats.inlinings.load() << " 箇所" << std::endl;
+            // トークン表現の大きさの比較用に、入力1MBあたりの確保量も出す
+            if (common::allocationCountingEnabled())
+            {
+                out << "メモリ確保量: " << (allocatedBytes + 1023) / 1024 << " KB（入力1MBあたり "
+                    << (stats.inputBytes > 0 ? static_cast<double>(allocatedBytes) / 1024.0 / (static_cast<double>(stats.inputBytes) / 1048576.0) : 0.0)
+                    << " KB）" << std::endl;
+            }
+            else
+            {
+                out << "メモリ確保量: 計測なし（allocation_hook.cpp をリンクしていないビルド）" << std::endl;
+            }
+        }
+        out << std::fixed << std::setprecision(3);
+        out << "出力: " << stats.outputBytes << " bytes" << std::endl;
+        out << "経過時間: " << milliseconds(stats.wallNanoseconds) << " ms" << std::endl;
+        out << "================" << std::endl;
+
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    void writeStatsJson(std::ostream &out, const PreprocessStats &stats)
+    {
+        const std::ios::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+
+        std::uint64_t allocatedBytes = 0;
+        for (const auto &stage : stats.stages)
+        {
+            allocatedBytes += stage.allocatedBytes.load();
+        }
+
+        out << std::fixed << std::setprecision(6);
+        out << "{\n";
+        out << "  \"input_bytes\": " << stats.inputBytes << ",\n";
+        out << "  \"output_bytes\": " << stats.outputBytes << ",\n";
+        out << "  \"blocks\": " << stats.blocks << ",\n";
+        out << "  \"definitions\": " << stats.definitions << ",\n";
+        out << "  \"resolved_definitions\": " << stats.resolvedDefinitions << ",\n";
+        out << "  \"inlinings\": " << stats.inlinings.load() << ",\n";
+        out << "  \"cache_hit\": " << (stats.cacheHit ? "true" : "false") << ",\n";
+        out << "  \"wall_ms\": " << milliseconds(stats.wallNanoseconds) << ",\n";
+        out << "  \"allocated_bytes\": " << allocatedBytes << ",\n";
+        out << "  \"allocations_counted\": " << (common::allocationCountingEnabled() ? "true" : "false") << ",\n";
+        out << "  \"stages\": [";
+        for (size_t i = 0; i < PREPROCESS_STAGE_COUNT; ++i)
+        {
+            const StageStats &stage = stats.stages[i];
+            out << (i > 0 ? "," : "") << "\n    {"
+                << "\"name\": \"" << preprocessStageName(static_cast<PreprocessStage>(i)) << "\""
+                << ", \"ms\": " << milliseconds(stage.nanoseconds.load())
+                << ", \"calls\": " << stage.calls.load()
+                << ", \"tokens\": " << stage.tokens.load()
+                << ", \"allocated_bytes\": " << stage.allocatedBytes.load() << "}";
+        }
+        out << "\n  ]\n}\n";
+
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+} // namespace sign
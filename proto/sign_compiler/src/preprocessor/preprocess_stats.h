@@ -0,0 +1,172 @@
+// src/preprocessor/preprocess_stats.h
+/**
+ * プリプロセスの段階ごとの統計
+ *
+ * 機能:
+ * - 段階ごとの処理時間・出力トークン数・メモリ確保量の集計（並列に処理するブロックからも安全に加算できる）
+ * - ブロック数・定義数・インライン展開の箇所数・入出力サイズの記録
+ * - 人が読む形式とJSON形式での出力
+ *
+ * SIGN_NO_STATS を定義してビルドした場合、計測のフック（measureStage, addStageTokens）は
+ * 処理をそのまま呼ぶだけになり、計測のコードは残らない。
+ * measureStage は統計とは別に、段階の名前でトレースの区間も記録する（common/utils/trace.h）。
+ *
+ * ver_20261016_1
+ */
+
+#ifndef SIGN_PREPROCESS_STATS_H
+#define SIGN_PREPROCESS_STATS_H
+
+#include "common/utils/allocation_counter.h"
+#include "common/utils/trace.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace sign
+{
+
+    // 統計を取れるビルドかどうか
+#ifdef SIGN_NO_STATS
+    constexpr bool STATS_AVAILABLE = false;
+#else
+    constexpr bool STATS_AVAILABLE = true;
+#endif
+
+    // プリプロセスの段階
+    // コメント削除とブロック分割は1パスで行うため、NORMALIZE にまとめて計測する
+    enum class PreprocessStage
+    {
+        NORMALIZE,           // 正規化とブロック分割
+        TOKENIZE,            // トークン化
+        LAMBDA,              // ラムダ式の処理
+        PARTIAL,             // 部分適用の処理
+        EXTRACT_DEFINITIONS, // 定義の抽出
+        RESOLVE,             // 定義の解決
+        APPLY,               // 定義の展開（インライン展開の計画を含む）
+        GENERATE,            // 最終コードの生成と書き出し
+        COUNT
+    };
+
+    constexpr size_t PREPROCESS_STAGE_COUNT = static_cast<size_t>(PreprocessStage::COUNT);
+
+    // 段階の名前（出力用）
+    const char *preprocessStageName(PreprocessStage stage);
+
+    // 段階1つの集計（ブロックごとの段階は各スレッドの処理時間の合計）
+    struct StageStats
+    {
+        std::atomic<std::uint64_t> nanoseconds{0};    // 処理時間
+        std::atomic<std::uint64_t> allocatedBytes{0}; // メモリ確保量
+        std::atomic<std::uint64_t> tokens{0};         // 出力トークン数
+        std::atomic<std::uint64_t> calls{0};          // 呼び出し回数
+    };
+
+    // プリプロセス1回の統計
+    struct PreprocessStats
+    {
+        std::array<StageStats, PREPROCESS_STAGE_COUNT> stages;
+        std::uint64_t inputBytes = 0;          // 入力サイズ
+        std::uint64_t outputBytes = 0;         // 出力サイズ
+        std::uint64_t blocks = 0;              // ブロック数
+        std::uint64_t definitions = 0;         // 抽出した定義の数
+        std::uint64_t resolvedDefinitions = 0; // 解決できた定義の数（循環定義を除く）
+        std::atomic<std::uint64_t> inlinings{0}; // インライン展開した箇所の数
+        std::uint64_t wallNanoseconds = 0;     // 全体の経過時間
+        bool cacheHit = false;                 // キャッシュの結果を使った
+
+        StageStats &operator[](PreprocessStage stage) { return stages[static_cast<size_t>(stage)]; }
+        const StageStats &operator[](PreprocessStage stage) const { return stages[static_cast<size_t>(stage)]; }
+    };
+
+#ifndef SIGN_NO_STATS
+
+    // 段階の処理時間とメモリ確保量を計測するスコープ
+    class StageScope
+    {
+    public:
+        StageScope(PreprocessStats &stats, PreprocessStage stage)
+            : target(stats[stage]), allocatedAtStart(common::threadAllocatedBytes()),
+              start(std::chrono::steady_clock::now()) {}
+
+        ~StageScope()
+        {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            target.nanoseconds.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                                         std::memory_order_relaxed);
+            target.allocatedBytes.fetch_add(common::threadAllocatedBytes() - allocatedAtStart, std::memory_order_relaxed);
+            target.calls.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        StageScope(const StageScope &) = delete;
+        StageScope &operator=(const StageScope &) = delete;
+
+    private:
+        StageStats &target;
+        std::uint64_t allocatedAtStart;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * 段階の処理を計測しながら実行する
+     *
+     * @param stats 統計の記録先（nullptrなら計測しない）
+     * @param stage 段階
+     * @param body 処理
+     * @return 処理の戻り値
+     */
+    template <typename Body>
+    decltype(auto) measureStage(PreprocessStats *stats, PreprocessStage stage, Body &&body)
+    {
+        common::TraceSpan span(preprocessStageName(stage));
+        if (stats == nullptr)
+        {
+            return body();
+        }
+        StageScope scope(*stats, stage);
+        return body();
+    }
+
+    // 段階の出力トークン数を加算する
+    inline void addStageTokens(PreprocessStats *stats, PreprocessStage stage, size_t tokens)
+    {
+        if (stats != nullptr)
+        {
+            (*stats)[stage].tokens.fetch_add(tokens, std::memory_order_relaxed);
+        }
+    }
+
+#else
+
+    template <typename Body>
+    decltype(auto) measureStage(PreprocessStats *, PreprocessStage stage, Body &&body)
+    {
+        common::TraceSpan span(preprocessStageName(stage));
+        return body();
+    }
+
+    inline void addStageTokens(PreprocessStats *, PreprocessStage, size_t) {}
+
+#endif // SIGN_NO_STATS
+
+    /**
+     * 統計を人が読む形式で出力する
+     *
+     * @param out 出力先
+     * @param stats 統計
+     */
+    void writeStatsText(std::ostream &out, const PreprocessStats &stats);
+
+    /**
+     * 統計をJSON形式で出力する
+     *
+     * @param out 出力先
+     * @param stats 統計
+     */
+    void writeStatsJson(std::ostream &out, const PreprocessStats &stats);
+
+} // namespace sign
+
+#endif // SIGN_PREPROCESS_STATS_H
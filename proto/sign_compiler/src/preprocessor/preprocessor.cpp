@@ -15,10 +15,11 @@
  * ※最小実装では「主な処理」に記載の内容以外は後回し
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_1
  */
 #include "preprocessor/preprocessor.h"
-#include "common/utils/string_utils.h"
+#include "common/parser/source_normalizer.h"
+#include <utility>
 
 namespace sign
 {
@@ -26,13 +27,16 @@ namespace sign
     // メイン処理：全ての前処理を実行
     std::string normalizeSourceCode(const std::string &sourceCode)
     {
-        // 現在はコメント削除のみ実装
-        std::string processed = common::removeComments(sourceCode);
-
-        // カッコの統一
-        processed = common::unifyBrackets(processed);
+        // コメント削除とカッコの統一を1パスで行う
+        return common::normalizeSource(sourceCode).code;
+    }
 
-        return processed;
+    // 正規化と同時に正規化後のコードの構造文字索引を構築
+    std::string normalizeSourceCode(const std::string &sourceCode, common::StructuralIndex &index)
+    {
+        common::NormalizedSource normalized = common::normalizeSource(sourceCode);
+        index = std::move(normalized.index);
+        return std::move(normalized.code);
     }
 
 } // namespace sign
\ No newline at end of file
@@ -9,11 +9,12 @@
  * - ソースコードの前処理パイプライン管理
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_0
  */
 #ifndef SIGN_PREPROCESSOR_H
 #define SIGN_PREPROCESSOR_H
 
+#include "common/lexer/structural_index.h"
 #include "common/utils/string_utils.h"
 #include <string>
 
@@ -47,6 +48,15 @@ namespace sign
      */
     std::string normalizeSourceCode(const std::string &sourceCode);
 
+    /**
+     * ソースコード正規化（正規化後のコードの構造文字索引も構築する）
+     * 索引はブロック抽出とトークン化でそのまま再利用できる
+     * @param sourceCode 処理対象のソースコード
+     * @param index 正規化されたソースコードの構造文字索引（出力）
+     * @return 正規化されたソースコード
+     */
+    std::string normalizeSourceCode(const std::string &sourceCode, common::StructuralIndex &index);
+
 } // namespace sign
 
 #endif // SIGN_PREPROCESSOR_H
\ No newline at end of file
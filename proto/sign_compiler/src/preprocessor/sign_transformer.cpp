@@ -3,15 +3,22 @@
  * Sign言語の処理済みコードを最終形式に変換する実装
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_12
  */
 
 #include "preprocessor/sign_transformer.h"
 #include "preprocessor/preprocessor.h"
-#include "common/parser/block_extractor.h"
+#include "common/parser/source_normalizer.h"
+#include "preprocessor/inliner.h"
 #include "preprocessor/lambda_processor.h"
+#include "preprocessor/preprocess_cache.h"
 #include "common/utils/file_utils.h"
+#include "common/utils/trace.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <sstream>
 
 namespace sign
@@ -34,49 +41,223 @@ namespace sign
         return result.str();
     }
 
+    // 処理されたブロックのトークン列を直列化して最終的なSignコードを生成する
+    std::string generateFinalCode(const std::vector<std::vector<common::Token>> &processedBlocks)
+    {
+        common::StringSink output;
+        writeFinalCode(output, processedBlocks);
+        return output.take();
+    }
+
+    // ブロック1つを直列化して書き出す（buffer はブロック間で再利用する）
+    static void writeBlock(common::OutputSink &output, const std::vector<common::Token> &tokens, bool first, std::string &buffer)
+    {
+        buffer.clear();
+        if (!first)
+        {
+            buffer += '\n'; // ブロック間に空行を挿入
+        }
+        common::appendTokens(buffer, tokens);
+        output.write(buffer);
+    }
+
+    // 処理されたブロックのトークン列をブロックごとに直列化して書き出す
+    void writeFinalCode(common::OutputSink &output, const std::vector<std::vector<common::Token>> &processedBlocks)
+    {
+        std::string buffer;
+        for (size_t i = 0; i < processedBlocks.size(); ++i)
+        {
+            writeBlock(output, processedBlocks[i], i == 0, buffer);
+        }
+    }
+
     // ソースコードを処理してプリプロセス済みのコードを生成する
     std::string preprocessSourceCode(const std::string &sourceCode)
     {
-        // ステップ1: コメント削除と空白の正規化
-        std::string normalizedCode = normalizeSourceCode(sourceCode);
+        return preprocessSourceCode(sourceCode, PreprocessOptions());
+    }
 
-        // ステップ2: ブロック抽出
-        std::vector<std::string> blocks = common::extractCodeBlocks(normalizedCode);
+    // ソースコードを処理してプリプロセス済みのコードを生成する（並列実行対応）
+    std::string preprocessSourceCode(const std::string &sourceCode, const PreprocessOptions &options)
+    {
+        common::StringSink output;
+        preprocessSourceCode(sourceCode, output, options);
+        return output.take();
+    }
 
-        // ステップ3: ラムダ式と部分適用の処理
-        std::vector<std::string> processedBlocks;
-        for (const auto &block : blocks)
+    // ソースコードを処理し、プリプロセス済みのコードをブロックごとに出力先へ書き出す
+    bool preprocessSourceCode(const std::string &sourceCode, common::OutputSink &output, const PreprocessOptions &options)
+    {
+        common::TraceSpan span("preprocess", "bytes", static_cast<std::int64_t>(sourceCode.size()));
+
+        // キャッシュは既定のインライン展開の結果のみ扱う（レポート指定時は実際に処理する）
+        const bool customInlining = !options.inlining.isDefault() || options.inlineReport != nullptr;
+        const PreprocessCache *cache = customInlining ? nullptr : options.cache;
+
+        // 統計の記録先（統計を取れないビルドでは常に nullptr なので、計測のコードは除去される）
+        PreprocessStats *stats = STATS_AVAILABLE ? options.stats : nullptr;
+        std::chrono::steady_clock::time_point started;
+        const size_t outputStart = output.bytesWritten();
+        if (stats != nullptr)
+        {
+            started = std::chrono::steady_clock::now();
+            stats->inputBytes = sourceCode.size();
+        }
+        const auto finishStats = [&](bool cacheHit)
         {
-            // ラムダ式と部分適用の処理のみを行う
-            std::vector<common::Token> tokens = common::tokenizeBlock(block);
-            std::vector<common::Token> afterLambda = processLambdaExpressions(tokens);
-            std::vector<common::Token> afterPartial = processPartialApplications(afterLambda);
+            if (stats != nullptr)
+            {
+                stats->cacheHit = cacheHit;
+                stats->outputBytes = output.bytesWritten() - outputStart;
+                stats->wallNanoseconds = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
+            }
+        };
 
-            // 処理済みブロックに追加
-            std::stringstream result;
-            for (size_t i = 0; i < afterPartial.size(); ++i)
+        // キャッシュにあれば保存済みの出力を返す
+        if (cache != nullptr)
+        {
+            if (std::optional<CacheEntry> entry = cache->lookup(sourceCode))
             {
-                result << afterPartial[i].value;
-                if (i < afterPartial.size() - 1)
+                output.write(entry->output);
+                const bool written = output.flush();
+                finishStats(true);
+                return written;
+            }
+        }
+
+        // 共有プールがなく並列実行が指定された場合は、この呼び出し用のプールを生成
+        std::unique_ptr<common::ThreadPool> ownedPool;
+        common::ThreadPool *pool = options.pool;
+        if (pool == nullptr && options.jobs != 1)
+        {
+            ownedPool = std::make_unique<common::ThreadPool>(options.jobs);
+            pool = ownedPool.get();
+        }
+
+        // ステップ1〜2: コメント削除・カッコの統一・ブロック分割を1パスで行う
+        // （ブロックは正規化済みコード内の範囲、構造文字索引もここで一度だけ構築）
+        common::NormalizedSource normalized = measureStage(stats, PreprocessStage::NORMALIZE, [&]
+                                                           { return common::normalizeSource(sourceCode); });
+        const std::string &normalizedCode = normalized.code;
+        const common::StructuralIndex &index = normalized.index;
+        const size_t blockCount = normalized.blocks.size();
+        if (stats != nullptr)
+        {
+            stats->blocks = blockCount;
+        }
+
+        // ステップ3: ラムダ式と部分適用の処理（ブロックごとに独立なので並列に実行）
+        // 以降はブロックごとのトークン列を保持し、文字列に戻すのは最終出力のみ
+        // 結果はブロックの位置に格納するため、出力順は実行順に依存しない
+        // ブロック内の処理は括弧の対応表付きのトークン列で行い、索引は処理後に破棄する
+        std::vector<std::vector<common::Token>> processedBlocks(blockCount);
+        common::ThreadPool::parallelFor(pool, blockCount, [&](size_t i)
+                                        {
+                                            common::TraceSpan blockSpan("block", "index", static_cast<std::int64_t>(i));
+                                            const common::BlockSpan &span = normalized.blocks[i];
+                                            std::string_view block(normalizedCode.data() + span.offset, span.length);
+                                            common::TokenStream tokens = measureStage(stats, PreprocessStage::TOKENIZE, [&]
+                                                                                      { return common::tokenizeStream(block, index, span.offset); });
+                                            addStageTokens(stats, PreprocessStage::TOKENIZE, tokens.size());
+                                            common::TokenStream afterLambda = measureStage(stats, PreprocessStage::LAMBDA, [&]
+                                                                                           { return processLambdaExpressions(std::move(tokens)); });
+                                            addStageTokens(stats, PreprocessStage::LAMBDA, afterLambda.size());
+                                            processedBlocks[i] = measureStage(stats, PreprocessStage::PARTIAL, [&]
+                                                                              { return processPartialApplications(std::move(afterLambda)).release(); });
+                                            addStageTokens(stats, PreprocessStage::PARTIAL, processedBlocks[i].size()); });
+
+        // ステップ4: すべてのブロックから定義を抽出し、コンパイル単位で一度だけ解決
+        // （抽出した定義表は解決後に不要になるので、このスコープで解放する）
+        auto definitions = [&]
+        {
+            const DefinitionTable extracted = measureStage(stats, PreprocessStage::EXTRACT_DEFINITIONS, [&]
+                                                           { return extractDefinitions(processedBlocks); });
+            auto resolved = measureStage(stats, PreprocessStage::RESOLVE, [&]
+                                         { return resolveDefinitions(extracted); });
+            if (stats != nullptr)
+            {
+                stats->definitions = extracted.size();
+                stats->resolvedDefinitions = 0;
+                for (const auto &[name, tokens] : extracted)
+                {
+                    addStageTokens(stats, PreprocessStage::EXTRACT_DEFINITIONS, tokens.size());
+                }
+                for (const auto &[name, definition] : *resolved)
                 {
-                    result << " ";
+                    stats->resolvedDefinitions += definition.circular ? 0 : 1;
+                    addStageTokens(stats, PreprocessStage::RESOLVE, definition.tokens.size());
                 }
             }
-            processedBlocks.push_back(result.str());
-        }
+            return resolved;
+        }();
 
-        // ステップ4: すべてのブロックから定義を抽出
-        auto definitions = extractDefinitions(processedBlocks);
+        // ステップ5: 解決済みの定義でブロックを処理（定義と展開計画は不変なので全ブロックで共有）
+        // 既定の設定以外では、全ブロックの使用回数からインライン展開の計画を立てる
+        const InlinePlan plan = measureStage(stats, PreprocessStage::APPLY, [&]
+                                             { return customInlining ? InlinePlan(*definitions, processedBlocks, options.inlining, pool) : InlinePlan(); });
 
-        // ステップ5: 抽出した定義でブロックを処理
-        std::vector<std::string> finalBlocks;
-        for (const auto &block : processedBlocks)
+        // 展開の実績はレポートか統計の指定時のみ記録する（統計のみなら定義ごとの内訳は不要）
+        std::vector<InlineStats> inlineStats((options.inlineReport != nullptr || stats != nullptr) ? blockCount : 0);
+        for (InlineStats &blockStats : inlineStats)
         {
-            finalBlocks.push_back(applyDefinitions(block, definitions));
+            blockStats.perDefinition = options.inlineReport != nullptr;
         }
 
         // ステップ6: 最終コード生成
-        return generateFinalCode(finalBlocks);
+        // キャッシュに保存する場合は出力全体も文字列に残す
+        common::StringSink cached;
+        common::TeeSink tee(output, cached);
+        common::OutputSink &sink = (cache != nullptr) ? static_cast<common::OutputSink &>(tee) : output;
+
+        // 一定数のブロックずつ並列に展開し、順に直列化して書き出す
+        const size_t concurrency = (pool != nullptr) ? pool->concurrency() : 1;
+        const size_t window = std::max<size_t>(64, concurrency * 8);
+        std::vector<std::vector<common::Token>> finalBlocks(std::min(window, blockCount));
+        std::string buffer;
+        for (size_t start = 0; start < blockCount; start += window)
+        {
+            const size_t count = std::min(window, blockCount - start);
+            common::ThreadPool::parallelFor(pool, count, [&](size_t k)
+                                            {
+                                                const size_t i = start + k;
+                                                common::TraceSpan blockSpan("block", "index", static_cast<std::int64_t>(i));
+                                                finalBlocks[k] = measureStage(stats, PreprocessStage::APPLY, [&]
+                                                                              { return applyDefinitions(processedBlocks[i], *definitions, plan,
+                                                                                                        inlineStats.empty() ? nullptr : &inlineStats[i]); });
+                                                addStageTokens(stats, PreprocessStage::APPLY, finalBlocks[k].size()); });
+            measureStage(stats, PreprocessStage::GENERATE, [&]
+                         {
+                             for (size_t k = 0; k < count; ++k)
+                             {
+                                 writeBlock(sink, finalBlocks[k], start + k == 0, buffer);
+                                 addStageTokens(stats, PreprocessStage::GENERATE, finalBlocks[k].size());
+                             } });
+        }
+        const bool written = measureStage(stats, PreprocessStage::GENERATE, [&]
+                                          { return sink.flush(); });
+
+        if (stats != nullptr)
+        {
+            for (const InlineStats &blockStats : inlineStats)
+            {
+                stats->inlinings += blockStats.inlinedCount;
+            }
+        }
+
+        if (options.inlineReport != nullptr)
+        {
+            writeInlineReport(*options.inlineReport, plan, inlineStats);
+        }
+
+        // 出力をキャッシュに保存（失敗しても処理結果には影響しない）
+        if (cache != nullptr)
+        {
+            cache->store(sourceCode, cached.take());
+        }
+
+        finishStats(false);
+        return written;
     }
 
     // ファイルからソースコードを読み込み、処理して出力する
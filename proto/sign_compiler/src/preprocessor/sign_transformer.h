@@ -8,19 +8,38 @@
  * - ファイル出力
  *
  * CreateBy: Claude3.7Sonnet
- * ver_20250521_0
+ * ver_20261016_5
  */
 
 #ifndef SIGN_TRANSFORMER_H
 #define SIGN_TRANSFORMER_H
 
+#include "common/lexer/token.h"
 #include "common/utils/file_utils.h"
+#include "common/utils/output_sink.h"
+#include "common/utils/thread_pool.h"
+#include "preprocessor/inliner.h"
+#include "preprocessor/preprocess_stats.h"
+#include <ostream>
 #include <string>
 #include <vector>
 
 namespace sign
 {
 
+    class PreprocessCache;
+
+    // プリプロセスの実行オプション
+    struct PreprocessOptions
+    {
+        size_t jobs = 1;                       // 同時実行数（1なら直列、0ならハードウェアのスレッド数）
+        common::ThreadPool *pool = nullptr;    // 共有するスレッドプール（指定時はjobsより優先）
+        const PreprocessCache *cache = nullptr; // 結果のディスクキャッシュ（指定時は検索・保存する）
+        InlineOptions inlining;                 // インライン展開の設定
+        std::ostream *inlineReport = nullptr;   // インライン展開のレポートの出力先（任意）
+        PreprocessStats *stats = nullptr;       // 段階ごとの統計の記録先（任意、SIGN_NO_STATS 指定時は記録しない）
+    };
+
     /**
      * 処理されたブロックを結合して最終的なSignコードを生成する
      *
@@ -29,6 +48,24 @@ namespace sign
      */
     std::string generateFinalCode(const std::vector<std::string> &processedBlocks);
 
+    /**
+     * 処理されたブロックのトークン列を直列化して最終的なSignコードを生成する
+     * パイプライン中でトークン列を文字列に戻すのはここだけ
+     *
+     * @param processedBlocks 処理済みのブロックごとのトークン列
+     * @return 結合された最終的なコード
+     */
+    std::string generateFinalCode(const std::vector<std::vector<common::Token>> &processedBlocks);
+
+    /**
+     * 処理されたブロックのトークン列をブロックごとに直列化して出力先に書き出す
+     * 出力は generateFinalCode と同一で、一度に保持する文字列は1ブロック分のみ
+     *
+     * @param output 出力先
+     * @param processedBlocks 処理済みのブロックごとのトークン列
+     */
+    void writeFinalCode(common::OutputSink &output, const std::vector<std::vector<common::Token>> &processedBlocks);
+
     /**
      * Sign言語コードをファイルに出力する (common::writeToFileへの転送)
      *
@@ -49,6 +86,28 @@ namespace sign
      */
     std::string preprocessSourceCode(const std::string &sourceCode);
 
+    /**
+     * ソースコードを処理してプリプロセス済みのコードを生成する
+     * ブロックごとの処理を並列に実行し、出力は直列実行と同一になる
+     *
+     * @param sourceCode 入力ソースコード
+     * @param options 実行オプション
+     * @return 処理済みのコード
+     */
+    std::string preprocessSourceCode(const std::string &sourceCode, const PreprocessOptions &options);
+
+    /**
+     * ソースコードを処理し、プリプロセス済みのコードをブロックごとに出力先へ書き出す
+     * 定義の展開は一定数のブロックずつ行い、展開後のトークン列と出力文字列を
+     * ファイル全体分保持しない（キャッシュへの保存時のみ出力全体を保持する）
+     *
+     * @param sourceCode 入力ソースコード
+     * @param output 出力先
+     * @param options 実行オプション
+     * @return 出力先への書き込みに成功した場合はtrue
+     */
+    bool preprocessSourceCode(const std::string &sourceCode, common::OutputSink &output, const PreprocessOptions &options);
+
     /**
      * ファイルからソースコードを読み込み、処理して出力する
      *